@@ -51,7 +51,16 @@
 #define configUSE_TRACE_FACILITY				1
 #define configIDLE_SHOULD_YIELD					1
 #define configUSE_MUTEXES						1
-#define configCHECK_FOR_STACK_OVERFLOW			2
+/* Set configSTACK_SIZES_VALIDATED to 1 once the stack sizes have been set from the
+stack_audit.c recommendations: that drops the pattern check on every context switch. */
+#ifndef configSTACK_SIZES_VALIDATED
+	#define configSTACK_SIZES_VALIDATED			0
+#endif
+#if ( configSTACK_SIZES_VALIDATED == 1 )
+	#define configCHECK_FOR_STACK_OVERFLOW		0
+#else
+	#define configCHECK_FOR_STACK_OVERFLOW		2
+#endif
 #define configUSE_RECURSIVE_MUTEXES				1
 #define configQUEUE_REGISTRY_SIZE				20
 #define configUSE_MALLOC_FAILED_HOOK			1
@@ -83,6 +92,7 @@
 
 /* Run time stats gathering configuration options. */
 #define configRUN_TIME_COUNTER_TYPE				uint64_t
+#define configRUN_TIME_COUNTER_HZ				( 1000000ULL ) /* Not a kernel option: rate of ulGetRunTimeCounterValue(), see Run-time-stats-utils.c. */
 configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
 void vConfigureTimerForRunTimeStats( void );	/* Prototype of function that initialises the run time counter. */
 #define configGENERATE_RUN_TIME_STATS			1
@@ -128,6 +138,25 @@ uses the same semantics as the standard C assert() macro. */
 extern void vAssertCalled( unsigned long ulLine, const char * const pcFileName );
 #define configASSERT( x ) if( ( x ) == 0 ) vAssertCalled( __LINE__, __FILE__ )
 
+/* No tickless idle: the Win32 port's 1 ms tick thread lives in port.c and cannot be
+paused, so ticks would not be suppressed.  Instead vApplicationIdleHook() in main.c
+sleeps the idle thread on the host (idle-thread host sleep): the ticks, and the tick
+hook, still run every millisecond, but the idle task no longer spins a host core. */
+#define configUSE_TICKLESS_IDLE					0
+
+/* Per-region heap_5 accounting, see heap_stats.h.  The trace recorder defines the
+same two macros, so this has to go if trcRecorder.h is included below. */
+void vHeapStatsOnMalloc( void * pvAddress, size_t xSize );
+void vHeapStatsOnFree( void * pvAddress, size_t xSize );
+#define traceMALLOC( pvAddress, uiSize )	vHeapStatsOnMalloc( ( pvAddress ), ( uiSize ) )
+#define traceFREE( pvAddress, uiSize )		vHeapStatsOnFree( ( pvAddress ), ( uiSize ) )
+
+/* Context switch count and switch-in time for the replay benchmark, see bench.h.  Also
+clashes with the trace recorder's definition. */
+extern volatile uint32_t ulBenchContextSwitches;
+extern volatile configRUN_TIME_COUNTER_TYPE ullBenchSwitchedInAt;
+#define traceTASK_SWITCHED_IN()		do { ulBenchContextSwitches++; ullBenchSwitchedInAt = portGET_RUN_TIME_COUNTER_VALUE(); } while( 0 )
+
 #define configINCLUDE_MESSAGE_BUFFER_AMP_DEMO	0
 #if ( configINCLUDE_MESSAGE_BUFFER_AMP_DEMO == 1 )
 	extern void vGenerateCoreBInterrupt( void * xUpdatedMessageBuffer );
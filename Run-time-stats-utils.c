@@ -0,0 +1,64 @@
+/*
+ * Utility functions required to gather run time statistics.  See:
+ * http://www.freertos.org/rtos-run-time-stats.html
+ *
+ * The time base is the Windows high resolution performance counter, scaled to
+ * configRUN_TIME_COUNTER_HZ (microseconds), so per task CPU time and response
+ * times well below one tick can be measured.  Note that this is a simulated
+ * port: the FreeRTOS threads do not run continuously, so the readings are host
+ * wall clock time rather than time on a real target.
+ *
+ * configRUN_TIME_COUNTER_TYPE is 64 bits wide, so the counter does not wrap in
+ * any practical run length.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Variables used in the creation of the run time stats time base.  Run time
+ * stats record how much time each task spends in the Running state. */
+static long long llInitialRunTimeCounterValue = 0LL;
+static long long llPerformanceCounterFrequency = 0LL;
+
+/*-----------------------------------------------------------*/
+
+void vConfigureTimerForRunTimeStats(void)
+{
+    LARGE_INTEGER liPerformanceCounterFrequency, liInitialRunTimeValue;
+
+    /* Initialise the variables used to create the run time stats time base.
+     * The performance counter frequency is fixed at boot, so it only needs
+     * to be read once. */
+    if (QueryPerformanceFrequency(&liPerformanceCounterFrequency) != 0)
+    {
+        /* What is the performance counter value now, this will be subtracted
+         * from readings taken at run time. */
+        QueryPerformanceCounter(&liInitialRunTimeValue);
+        llInitialRunTimeCounterValue = liInitialRunTimeValue.QuadPart;
+        llPerformanceCounterFrequency = liPerformanceCounterFrequency.QuadPart;
+    }
+}
+/*-----------------------------------------------------------*/
+
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue(void)
+{
+    LARGE_INTEGER liCurrentCount;
+    long long llElapsed;
+
+    /* The trace macros can call this function before the kernel has been
+     * started, in which case the frequency is still 0. */
+    if (llPerformanceCounterFrequency == 0LL)
+    {
+        return 0;
+    }
+
+    QueryPerformanceCounter(&liCurrentCount);
+    llElapsed = liCurrentCount.QuadPart - llInitialRunTimeCounterValue;
+
+    /* Scale to configRUN_TIME_COUNTER_HZ in two parts so the multiplication
+     * cannot overflow however long the demo runs. */
+    return (configRUN_TIME_COUNTER_TYPE)
+        ((llElapsed / llPerformanceCounterFrequency) * configRUN_TIME_COUNTER_HZ +
+         ((llElapsed % llPerformanceCounterFrequency) * configRUN_TIME_COUNTER_HZ) / llPerformanceCounterFrequency);
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,129 @@
+/* bench.h
+   Replay benchmark for the EDF and fault-tolerant scheduling policies.
+   - a BenchCase describes a task set (period, deadline, execution range, overrun chance and
+     cost, backup cost), the policy to run it under, a default seed and a run length
+   - every task draws its jobs from its own Prng stream (seed, task index), so a given case
+     and seed replays the same job sequence however the tasks interleave
+   - jobs consume CPU time (vBenchExecute spins on the task's own run-time counter) rather
+     than sleeping, so they really compete for the processor
+   - at the end of the run one JSON object per task and one summary object are printed, one
+     per line, and the process exits
+   The case and seed come from the FREERTOS_BENCH_CASE and FREERTOS_BENCH_SEED environment
+   variables; without them the first case runs with its own seed.
+   Scaling: edf_scale_50, edf_scale_100 and edf_scale_200 run 50 to 200 light tasks at the
+   same total load, generated at selection time; the summary's scheduler pass and re-key
+   costs should stay flat across them, since the ready queue is a heap (edf_queue.h) and the
+   band map only looks at the earliest ranks (edf_bands.h).
+   Partitioned EDF: with FREERTOS_BENCH_CORES=N an EDF case is packed onto N processors
+   (edf_partition.h) and the process runs only partition FREERTOS_BENCH_PARTITION (default
+   0) under its own scheduler. Partitions share nothing, so N processes, one per partition
+   and each on its own host core (e.g. start /affinity), simulate the N-core target in
+   parallel and give the same results as one N-core run; their lines carry "partition".
+   Context switches are counted through traceTASK_SWITCHED_IN in FreeRTOSConfig.h.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "FreeRTOS.h"
+#include "prng.h"
+#include "job_stats.h"
+
+#define BENCH_MAX_TASKS 200
+#define BENCH_SCALE_TASKS 200 // largest of the generated edf_scale_N sets
+
+typedef enum {
+    BENCH_POLICY_EDF = 0,
+    BENCH_POLICY_FT
+} BenchPolicy;
+
+typedef struct {
+    const char* name;
+    uint32_t periodMs;
+    uint32_t deadlineMs;      // relative
+    uint32_t execMinUs;       // a normal job runs for a uniform draw in [execMinUs, execMaxUs]
+    uint32_t execMaxUs;
+    uint32_t overrunPermille; // chance that a job overruns
+    uint32_t overrunExecUs;   // what an overrunning job runs for
+    uint32_t backupExecUs;    // FT only: what the backup runs for when it takes over
+} BenchTaskSpec;
+
+typedef struct {
+    const char* name;
+    BenchPolicy policy;
+    uint32_t seed;
+    uint32_t durationMs;
+    const BenchTaskSpec* tasks;
+    UBaseType_t count;
+} BenchCase;
+
+/* Per-task job source. */
+typedef struct {
+    const BenchTaskSpec* spec;
+    Prng prng;
+} BenchJobModel;
+
+/* Which partition of a partitioned run this process is, for the results. */
+typedef struct {
+    UBaseType_t cores;
+    UBaseType_t partition;
+    uint32_t utilisationPpm; // of this partition
+    UBaseType_t unassigned;  // tasks of the case that fit no partition and ran nowhere
+} BenchPartition;
+
+/* Cost of the EDF scheduler task, in run-time counter units: one pass is one wake-up, which
+   re-keys every task whose deadline moved (rekeys) and re-derives the priority bands. */
+typedef struct {
+    uint32_t passes;
+    uint32_t rekeys;
+    uint32_t priorityChanges;
+    configRUN_TIME_COUNTER_TYPE total;
+    configRUN_TIME_COUNTER_TYPE max;
+} BenchSchedulerCost;
+
+/* Metrics of one task at the end of the run. */
+typedef struct {
+    const char* name;
+    uint32_t jobs;
+    uint32_t deadlineMisses;
+    uint32_t backupActivations;
+    const JobStats* stats;
+} BenchTaskResult;
+
+extern volatile uint32_t ulBenchContextSwitches;
+extern volatile configRUN_TIME_COUNTER_TYPE ullBenchSwitchedInAt;
+
+/* The case named by FREERTOS_BENCH_CASE, or the first one. */
+const BenchCase* pxBenchSelectCase(void);
+
+/* FREERTOS_BENCH_SEED if set, else the case's seed. */
+uint32_t ulBenchSeed(const BenchCase* pxCase);
+
+/* FREERTOS_BENCH_CORES if set, else 1 (no partitioning). */
+UBaseType_t uxBenchCores(void);
+
+/* FREERTOS_BENCH_PARTITION if set, else 0. */
+UBaseType_t uxBenchPartition(void);
+
+void vBenchModelInit(BenchJobModel* m, const BenchTaskSpec* pxSpec, uint32_t ulSeed, uint32_t ulStream);
+
+/* Draw the next job: its execution time in *pulExecUs; returns pdTRUE if it overruns. */
+BaseType_t xBenchNextJob(BenchJobModel* m, uint32_t* pulExecUs);
+
+/* CPU time of the calling task in run-time counter units: what the kernel has booked to
+   it so far plus the slice it is in now. */
+configRUN_TIME_COUNTER_TYPE ullBenchOwnRunTime(void);
+
+/* Spin until the calling task has had ulMicroseconds of CPU time. */
+void vBenchExecute(uint32_t ulMicroseconds);
+
+/* vBenchExecute() that gives up as soon as *pxStop is set, e.g. by a budget check in the
+   tick hook. Returns pdFALSE if it gave up. */
+BaseType_t xBenchExecuteUnless(uint32_t ulMicroseconds, const volatile BaseType_t* pxStop);
+
+/* Print the results as JSON lines. pxPartition is NULL unless the run is partitioned, and
+   pxScheduler NULL for a policy without a scheduler task. Call with the scheduler suspended. */
+void vBenchPrintResults(const BenchCase* pxCase, uint32_t ulSeed, const BenchPartition* pxPartition,
+    const BenchSchedulerCost* pxScheduler, const BenchTaskResult* pxResults, UBaseType_t uxCount);
+
+#endif /* BENCH_H */
@@ -0,0 +1,141 @@
+/* block_pool.c
+   Fixed-size block pools carved out of a heap_5 region (see block_pool.h).
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "block_pool.h"
+#include "stack_audit.h"
+
+typedef struct BlockPoolFree {
+    struct BlockPoolFree* next;
+} BlockPoolFree;
+
+typedef struct {
+    size_t blockBytes;
+    UBaseType_t blocks;
+    uint8_t* start;
+    uint8_t* end;
+    BlockPoolFree* freeList;
+    UBaseType_t freeBlocks;
+    UBaseType_t minFreeBlocks;
+} BlockPool;
+
+static BlockPool xPools[BLOCK_POOL_CLASS_COUNT] = {
+#define BLOCK_POOL_INIT(id, bytes, blocks) { BLOCK_POOL_ROUND(bytes), (blocks) },
+    BLOCK_POOL_CLASSES(BLOCK_POOL_INIT)
+#undef BLOCK_POOL_INIT
+};
+static volatile uint32_t ulHeapFallbacks = 0; // tasks xBlockPoolCreateTask() had to put on the heap
+
+void vBlockPoolInit(void* pvArea, size_t xBytes) {
+    uint8_t* pucNext = (uint8_t*)BLOCK_POOL_ROUND((size_t)pvArea);
+    uint8_t* pucEnd = (uint8_t*)pvArea + xBytes;
+
+    for (UBaseType_t c = 0; c < BLOCK_POOL_CLASS_COUNT; ++c) {
+        BlockPool* p = &xPools[c];
+        p->start = pucNext;
+        p->end = pucNext + p->blockBytes * p->blocks;
+        configASSERT(p->end <= pucEnd);
+
+        // thread the slab back to front so the list hands blocks out in address order
+        p->freeList = NULL;
+        for (uint8_t* b = p->end; b > p->start;) {
+            b -= p->blockBytes;
+            ((BlockPoolFree*)b)->next = p->freeList;
+            p->freeList = (BlockPoolFree*)b;
+        }
+        p->freeBlocks = p->minFreeBlocks = p->blocks;
+        pucNext = p->end;
+    }
+}
+
+static void* prvAlloc(BlockPoolClass eClass) {
+    BlockPool* p = &xPools[eClass];
+    BlockPoolFree* b;
+
+    taskENTER_CRITICAL();
+    b = p->freeList;
+    if (b != NULL) {
+        p->freeList = b->next;
+        if (--p->freeBlocks < p->minFreeBlocks) {
+            p->minFreeBlocks = p->freeBlocks;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return b;
+}
+
+/* Class whose slab holds pvBlock, or BLOCK_POOL_CLASS_COUNT for memory of the heap. */
+static UBaseType_t prvClassOf(const void* pvBlock) {
+    const uint8_t* pucBlock = (const uint8_t*)pvBlock;
+    UBaseType_t c = 0;
+    while (c < BLOCK_POOL_CLASS_COUNT && (pucBlock < xPools[c].start || pucBlock >= xPools[c].end)) {
+        ++c;
+    }
+    return c;
+}
+
+static void prvFree(BlockPool* p, void* pvBlock) {
+    configASSERT((size_t)((uint8_t*)pvBlock - p->start) % p->blockBytes == 0);
+    taskENTER_CRITICAL();
+    ((BlockPoolFree*)pvBlock)->next = p->freeList;
+    p->freeList = (BlockPoolFree*)pvBlock;
+    p->freeBlocks++;
+    taskEXIT_CRITICAL();
+}
+
+TaskHandle_t xBlockPoolCreateTask(TaskFunction_t pxCode, const char* pcName, configSTACK_DEPTH_TYPE usStackDepth,
+    void* pvParameters, UBaseType_t uxPriority) {
+    for (UBaseType_t c = 0; c < BLOCK_POOL_CLASS_COUNT; ++c) {
+        if (xPools[c].blockBytes < BLOCK_POOL_TASK_BYTES(usStackDepth)) {
+            continue;
+        }
+        uint8_t* pucBlock = prvAlloc((BlockPoolClass)c);
+        if (pucBlock == NULL) {
+            continue;
+        }
+        // give the task all of the block after the TCB, not just what it asked for
+        StackType_t* puxStack = (StackType_t*)(pucBlock + BLOCK_POOL_ROUND(sizeof(StaticTask_t)));
+        uint32_t ulDepth = (uint32_t)((xPools[c].blockBytes - BLOCK_POOL_ROUND(sizeof(StaticTask_t))) / sizeof(StackType_t));
+        TaskHandle_t xTask = xTaskCreateStatic(pxCode, pcName, ulDepth, pvParameters, uxPriority, puxStack, (StaticTask_t*)pucBlock);
+        vStackAuditRegister(xTask, (configSTACK_DEPTH_TYPE)ulDepth);
+        return xTask;
+    }
+
+    // every fitting class is exhausted: counted, since the task now depends on heap_5
+    taskENTER_CRITICAL();
+    ulHeapFallbacks++;
+    taskEXIT_CRITICAL();
+    TaskHandle_t xTask = NULL;
+    if (xTaskCreate(pxCode, pcName, usStackDepth, pvParameters, uxPriority, &xTask) != pdPASS) {
+        return NULL;
+    }
+    vStackAuditRegister(xTask, usStackDepth);
+    return xTask;
+}
+
+void vBlockPoolDeleteTask(TaskHandle_t xTask) {
+    configASSERT(xTask != NULL && xTask != xTaskGetCurrentTaskHandle());
+    vTaskDelete(xTask);
+    UBaseType_t c = prvClassOf(xTask); // the handle of a static task is its StaticTask_t buffer
+    if (c < BLOCK_POOL_CLASS_COUNT) {
+        prvFree(&xPools[c], xTask);
+    }
+}
+
+uint32_t ulBlockPoolHeapFallbacks(void) {
+    return ulHeapFallbacks;
+}
+
+UBaseType_t uxBlockPoolBlocks(BlockPoolClass eClass) {
+    return xPools[eClass].blocks;
+}
+
+UBaseType_t uxBlockPoolFreeBlocks(BlockPoolClass eClass) {
+    return xPools[eClass].freeBlocks;
+}
+
+UBaseType_t uxBlockPoolMinimumEverFreeBlocks(BlockPoolClass eClass) {
+    return xPools[eClass].minFreeBlocks;
+}
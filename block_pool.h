@@ -0,0 +1,74 @@
+/* block_pool.h
+   Fixed-size block pools for the TCBs and stacks of the demos' tasks.
+   - the size classes are the BLOCK_POOL_CLASSES table below; each class is one contiguous
+     slab of equal blocks, and all slabs together sit right after heap_5 region 3 in
+     main.c's heap array, so heap_5 never sees them
+   - free blocks of a class are kept on an intrusive singly linked list: allocation pops the
+     head and free pushes it, both O(1) and independent of fragmentation
+   - the class of a freed block is found from its address (one range check per class)
+   - a task block holds a StaticTask_t followed by its stack, so xBlockPoolCreateTask() gets
+     both from one pop, and the task handle is the block itself; when every task class that
+     fits is exhausted the task is created on the heap instead and the fallback is counted
+     (ulBlockPoolHeapFallbacks()), so a set that outgrows the pools shows up in the reports
+   Calls are guarded by a short critical section and are not for use from ISRs.
+*/
+
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define BLOCK_POOL_ROUND(x) (((x) + portBYTE_ALIGNMENT - 1) & ~((size_t)portBYTE_ALIGNMENT - 1))
+#define BLOCK_POOL_TASK_BYTES(depth) (BLOCK_POOL_ROUND(sizeof(StaticTask_t)) + (depth) * sizeof(StackType_t))
+
+/* Task blocks per class, sized for the largest sets main_blinky.c accepts: one small block
+   per EDF task or server (EDF_MAX_TASKS), a large one per FT primary and backup
+   (2 * FT_MAX_TASKS). main_blinky.c checks both at compile time. */
+#ifndef BLOCK_POOL_TASK_SMALL_BLOCKS
+#define BLOCK_POOL_TASK_SMALL_BLOCKS 200
+#endif
+#ifndef BLOCK_POOL_TASK_LARGE_BLOCKS
+#define BLOCK_POOL_TASK_LARGE_BLOCKS 16
+#endif
+
+/* X(id, block bytes, blocks), in increasing block size. */
+#define BLOCK_POOL_CLASSES(X) \
+    X(BLOCK_POOL_TASK_SMALL,  BLOCK_POOL_TASK_BYTES(configMINIMAL_STACK_SIZE),      BLOCK_POOL_TASK_SMALL_BLOCKS) \
+    X(BLOCK_POOL_TASK_LARGE,  BLOCK_POOL_TASK_BYTES(configMINIMAL_STACK_SIZE + 64), BLOCK_POOL_TASK_LARGE_BLOCKS)
+
+typedef enum {
+#define BLOCK_POOL_ENUM(id, bytes, blocks) id,
+    BLOCK_POOL_CLASSES(BLOCK_POOL_ENUM)
+#undef BLOCK_POOL_ENUM
+    BLOCK_POOL_CLASS_COUNT
+} BlockPoolClass;
+
+/* Bytes the slabs need, including the slack to align the start of the carved area. */
+#define BLOCK_POOL_SLAB_BYTES(id, bytes, blocks) + BLOCK_POOL_ROUND(bytes) * (blocks)
+#define BLOCK_POOL_TOTAL_BYTES (portBYTE_ALIGNMENT BLOCK_POOL_CLASSES(BLOCK_POOL_SLAB_BYTES))
+
+/* Lay the slabs out in [pvArea, pvArea + xBytes) and thread every block onto its free list.
+   Call once, before the scheduler starts. */
+void vBlockPoolInit(void* pvArea, size_t xBytes);
+
+/* Create a task whose TCB and stack come from the smallest task class that fits
+   usStackDepth, or from xTaskCreate() when none of those has a block free. Returns NULL
+   only if the heap is out of memory as well. */
+TaskHandle_t xBlockPoolCreateTask(TaskFunction_t pxCode, const char* pcName, configSTACK_DEPTH_TYPE usStackDepth,
+    void* pvParameters, UBaseType_t uxPriority);
+
+/* Delete a task made by xBlockPoolCreateTask() and free its block at once (a heap task's
+   memory goes back through the idle task as usual). Not for the
+   calling task itself: the kernel still runs on its stack until the switch away. */
+void vBlockPoolDeleteTask(TaskHandle_t xTask);
+
+/* Tasks xBlockPoolCreateTask() created on the heap because no pool block fitted. */
+uint32_t ulBlockPoolHeapFallbacks(void);
+
+/* Blocks of a class in all, free now, and the fewest free at any time. */
+UBaseType_t uxBlockPoolBlocks(BlockPoolClass eClass);
+UBaseType_t uxBlockPoolFreeBlocks(BlockPoolClass eClass);
+UBaseType_t uxBlockPoolMinimumEverFreeBlocks(BlockPoolClass eClass);
+
+#endif /* BLOCK_POOL_H */
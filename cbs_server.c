@@ -0,0 +1,40 @@
+/* cbs_server.c
+   Budget and deadline rules of the Constant Bandwidth Server (see cbs_server.h).
+*/
+
+#include "cbs_server.h"
+
+void vCBSServerInit(CBSServer* s, uint32_t ulBudgetUs, TickType_t xPeriod) {
+    configASSERT(ulBudgetUs > 0 && xPeriod > 0);
+    s->budgetUs = ulBudgetUs;
+    s->period = xPeriod;
+    s->remainingUs = ulBudgetUs;
+    s->deadline = 0;
+    s->replenishments = 0;
+}
+
+TickType_t xCBSServerArrival(CBSServer* s, TickType_t xNow) {
+    // ds - r, or 0 once the deadline has passed (ticks compare modulo wrap)
+    TickType_t xLeft = s->deadline - xNow;
+    if (xLeft >= (portMAX_DELAY / 2)) {
+        xLeft = 0;
+    }
+
+    // cs < (ds - r) * Qs / Ts, cross-multiplied
+    if ((uint64_t)s->remainingUs * s->period >= (uint64_t)xLeft * s->budgetUs) {
+        s->remainingUs = s->budgetUs;
+        s->deadline = xNow + s->period;
+    }
+    return s->deadline;
+}
+
+TickType_t xCBSServerCharge(CBSServer* s, uint32_t ulUsedUs) {
+    while (ulUsedUs >= s->remainingUs) {
+        ulUsedUs -= s->remainingUs;
+        s->remainingUs = s->budgetUs;
+        s->deadline += s->period;
+        s->replenishments++;
+    }
+    s->remainingUs -= ulUsedUs;
+    return s->deadline;
+}
@@ -0,0 +1,38 @@
+/* cbs_server.h
+   Constant Bandwidth Server (Abeni & Buttazzo) for aperiodic work under EDF.
+   - the server owns a budget Qs every period Ts, a bandwidth Us = Qs/Ts that the admission
+     test counts like a periodic task with C = Qs and T = D = Ts
+   - it is scheduled by its own absolute deadline ds, and the work it runs is charged
+     against its remaining budget cs
+   - a request reaching an idle server at time r keeps (cs, ds) while cs < (ds - r) * Us,
+     otherwise the server starts over with cs = Qs, ds = r + Ts
+   - an exhausted budget is recharged to Qs and ds moves one period later, so a server with
+     a backlog loses priority instead of taking time from the periodic tasks
+   - budgets are in microseconds of CPU time, deadlines in ticks; the caller serialises
+     access (in the demo only the server task touches it)
+*/
+
+#ifndef CBS_SERVER_H
+#define CBS_SERVER_H
+
+#include "FreeRTOS.h"
+
+typedef struct {
+    uint32_t budgetUs;    // Qs
+    TickType_t period;    // Ts
+    uint32_t remainingUs; // cs
+    TickType_t deadline;  // ds, absolute
+    uint32_t replenishments;
+} CBSServer;
+
+void vCBSServerInit(CBSServer* s, uint32_t ulBudgetUs, TickType_t xPeriod);
+
+/* A request arrives at xNow while the server has nothing pending. Returns the deadline to
+   schedule the server by. */
+TickType_t xCBSServerArrival(CBSServer* s, TickType_t xNow);
+
+/* Charge ulUsedUs of executed work; every exhausted budget postpones the deadline by one
+   period. Returns the deadline to schedule the server by. */
+TickType_t xCBSServerCharge(CBSServer* s, uint32_t ulUsedUs);
+
+#endif /* CBS_SERVER_H */
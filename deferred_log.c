@@ -0,0 +1,346 @@
+/* deferred_log.c
+   Deferred logging ring and drain task (see deferred_log.h).
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <windows.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "deferred_log.h"
+#include "stack_audit.h"
+#include "event_channel.h"
+
+#if ((LOG_RING_RECORDS & (LOG_RING_RECORDS - 1)) != 0)
+#error "LOG_RING_RECORDS must be a power of two"
+#endif
+
+/* Slot states in seq. A slot starts out free for the claims of the first lap, so the ring
+   needs no initialisation; publishing and freeing are compare-and-swaps from the free state
+   of the claim, so a writer the drain gave up on cannot publish into a slot handed on. */
+#define LOG_SEQ_FREE(claim) (((uint32_t)(claim) & ~(uint32_t)(LOG_RING_RECORDS - 1)) << 1)
+#define LOG_SEQ_PUBLISHED(claim) (((uint32_t)(claim) << 1) | 1u)
+
+typedef struct {
+    volatile uint32_t seq; // LOG_SEQ_FREE / LOG_SEQ_PUBLISHED of the slot's claim
+    TickType_t tick;
+    uint16_t id;           // LogFormatId
+    uint8_t argc;
+    uintptr_t args[LOG_MAX_ARGS];
+} LogRecord;
+
+/* How an argument word has to be fetched from a va_list and handed back to printf. */
+enum {
+    LOG_ARG_UINT = 0,
+    LOG_ARG_ULONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTR
+};
+
+#define LOG_FORMAT_STRING(id, fmt) fmt,
+static const char* const pcLogFormats[LOG_FORMAT_COUNT] = {
+    LOG_FORMAT_TABLE(LOG_FORMAT_STRING)
+};
+
+/* Argument count and types of each interned format, filled in once by vLogInit(). */
+static uint8_t ucLogArgc[LOG_FORMAT_COUNT];
+static uint8_t ucLogArgType[LOG_FORMAT_COUNT][LOG_MAX_ARGS];
+
+static LogRecord xLogRing[LOG_RING_RECORDS];
+static volatile uint32_t ulLogHead = 0;   // next claim index, shared by all writers
+static volatile uint32_t ulLogTail = 0;   // next record to print, only written by the drain
+static volatile uint32_t ulLogDropped = 0;
+static uint32_t ulLogStaleClaim = 0;      // claim the drain found unpublished on its last pass
+static UBaseType_t uxLogStalePasses = 0;  // consecutive drain passes it stayed that way
+static uint32_t ulLogDroppedReported = 0;
+static TaskHandle_t xLogDrain = NULL;
+
+/* Copy the conversion spec starting at p (which points at '%') into spec and return a pointer
+   past it, or NULL at the end of the string. *pcConv and *pcLength receive the conversion
+   character and the length modifier ('\0' when there is none). */
+static const char* prvNextConversion(const char* p, char* spec, size_t xSpecLen, char* pcConv, char* pcLength) {
+    size_t n = 0;
+    *pcLength = '\0';
+    spec[n++] = *p++;
+    while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL && n < xSpecLen - 3) {
+        spec[n++] = *p++;
+    }
+    if (*p == 'l' || *p == 'z' || *p == 'h') {
+        *pcLength = *p;
+        spec[n++] = *p++;
+    }
+    if (*p == '\0') {
+        return NULL;
+    }
+    *pcConv = *p;
+    spec[n++] = *p++;
+    spec[n] = '\0';
+    return p;
+}
+
+static uint8_t prvArgType(char conv, char length) {
+    if (conv == 's' || conv == 'p') {
+        return LOG_ARG_PTR;
+    }
+    if (length == 'l') {
+        return LOG_ARG_ULONG;
+    }
+    return (length == 'z') ? LOG_ARG_SIZE : LOG_ARG_UINT;
+}
+
+/* Walk fmt and record the type of up to uxMax arguments; returns how many there are. */
+static UBaseType_t prvParseArgs(const char* fmt, uint8_t* pucTypes, UBaseType_t uxMax) {
+    char spec[16], conv, length;
+    UBaseType_t uxCount = 0;
+    for (const char* p = strchr(fmt, '%'); p != NULL && uxCount < uxMax; p = strchr(p, '%')) {
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        if ((p = prvNextConversion(p, spec, sizeof(spec), &conv, &length)) == NULL) {
+            break;
+        }
+        pucTypes[uxCount++] = prvArgType(conv, length);
+    }
+    return uxCount;
+}
+
+static uintptr_t prvFetchArg(va_list* pap, uint8_t ucType) {
+    switch (ucType) {
+    case LOG_ARG_PTR:
+        return (uintptr_t)va_arg(*pap, const void*);
+    case LOG_ARG_ULONG:
+        return (uintptr_t)va_arg(*pap, unsigned long);
+    case LOG_ARG_SIZE:
+        return (uintptr_t)va_arg(*pap, size_t);
+    default:
+        return (uintptr_t)va_arg(*pap, unsigned int);
+    }
+}
+
+static void prvCountDrop(void) {
+    (void)InterlockedIncrement((volatile LONG*)&ulLogDropped);
+}
+
+/* Claim the next slot, or count a drop and return NULL when the ring is full. */
+static LogRecord* prvClaim(uint32_t* pulClaim) {
+    uint32_t ulClaim;
+    for (;;) {
+        ulClaim = ulLogHead;
+        if ((uint32_t)(ulClaim - ulLogTail) >= LOG_RING_RECORDS) {
+            prvCountDrop();
+            return NULL;
+        }
+        if ((uint32_t)InterlockedCompareExchange((volatile LONG*)&ulLogHead, (LONG)(ulClaim + 1), (LONG)ulClaim) == ulClaim) {
+            break;
+        }
+    }
+    LogRecord* r = &xLogRing[ulClaim & (LOG_RING_RECORDS - 1)];
+    r->tick = xTaskGetTickCount();
+    *pulClaim = ulClaim;
+    return r;
+}
+
+/* Make a filled record visible to the drain. Fails if the drain already gave the slot up. */
+static BaseType_t prvPublish(LogRecord* r, uint32_t ulClaim) {
+    MemoryBarrier(); // the record is complete before its state changes
+    if ((uint32_t)InterlockedCompareExchange((volatile LONG*)&r->seq, (LONG)LOG_SEQ_PUBLISHED(ulClaim),
+            (LONG)LOG_SEQ_FREE(ulClaim)) != LOG_SEQ_FREE(ulClaim)) {
+        return pdFAIL; // counted as dropped by the drain
+    }
+    return pdPASS;
+}
+
+BaseType_t xLogVPrintf(const char* fmt, va_list ap) {
+    uint8_t ucTypes[LOG_MAX_ARGS - 1];
+    uint32_t ulClaim;
+
+    // parse before claiming, so the slot is held only while words are copied
+    UBaseType_t uxCount = prvParseArgs(fmt, ucTypes, LOG_MAX_ARGS - 1);
+    LogRecord* r = prvClaim(&ulClaim);
+    if (r == NULL) {
+        return pdFAIL;
+    }
+
+    r->id = LOG_FORMAT_ADHOC;
+    r->args[0] = (uintptr_t)fmt;
+    va_list aq; // a va_list parameter cannot be passed on by address portably
+    va_copy(aq, ap);
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        r->args[i + 1] = prvFetchArg(&aq, ucTypes[i]);
+    }
+    va_end(aq);
+    r->argc = (uint8_t)(uxCount + 1);
+    return prvPublish(r, ulClaim);
+}
+
+BaseType_t xLogPrintf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    BaseType_t xResult = xLogVPrintf(fmt, ap);
+    va_end(ap);
+    return xResult;
+}
+
+BaseType_t xLogEvent(LogFormatId id, ...) {
+    BaseType_t xResult;
+    va_list ap;
+    va_start(ap, id);
+#if (LOG_INTERNED_FORMATS == 1)
+    {
+        uint32_t ulClaim;
+        LogRecord* r = prvClaim(&ulClaim);
+        xResult = pdFAIL;
+        if (r != NULL) {
+            r->id = (uint16_t)id;
+            r->argc = ucLogArgc[id];
+            for (UBaseType_t i = 0; i < r->argc; ++i) {
+                r->args[i] = prvFetchArg(&ap, ucLogArgType[id][i]);
+            }
+            xResult = prvPublish(r, ulClaim);
+        }
+    }
+#else
+    xResult = xLogVPrintf(pcLogFormats[id], ap);
+#endif
+    va_end(ap);
+    return xResult;
+}
+
+const char* pcLogFormatString(LogFormatId id) {
+    return (id < LOG_FORMAT_COUNT) ? pcLogFormats[id] : NULL;
+}
+
+static void prvPrintRecord(const LogRecord* r) {
+    char spec[16], conv, length;
+    const uintptr_t* pxArgs = r->args;
+    UBaseType_t uxArgc = r->argc;
+    const char* p;
+
+    if (r->id == LOG_FORMAT_ADHOC) {
+        p = (const char*)pxArgs[0];
+        pxArgs++;
+        uxArgc--;
+    }
+    else {
+        p = pcLogFormats[r->id];
+    }
+
+    printf("[%lu ms] ", (unsigned long)pdTICKS_TO_MS(r->tick));
+    while (*p != '\0') {
+        if (*p != '%') {
+            putchar(*p++);
+            continue;
+        }
+        if (p[1] == '%') {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+        if ((p = prvNextConversion(p, spec, sizeof(spec), &conv, &length)) == NULL) {
+            break;
+        }
+        uintptr_t v = (uxArgc > 0) ? (uxArgc--, *pxArgs++) : 0;
+        switch (prvArgType(conv, length)) {
+        case LOG_ARG_PTR:
+            if (conv == 's') {
+                printf(spec, (v != 0) ? (const char*)v : "(null)");
+            }
+            else {
+                printf(spec, (void*)v);
+            }
+            break;
+        case LOG_ARG_ULONG:
+            printf(spec, (unsigned long)v);
+            break;
+        case LOG_ARG_SIZE:
+            printf(spec, (size_t)v);
+            break;
+        default:
+            printf(spec, (unsigned int)v);
+            break;
+        }
+    }
+    putchar('\n');
+}
+
+/* Hand slot ulClaim on to the claim a lap later, from its published or its free state. */
+static BaseType_t prvRelease(LogRecord* r, uint32_t ulClaim, uint32_t ulFrom) {
+    MemoryBarrier(); // done with the record before a writer can reuse it
+    return ((uint32_t)InterlockedCompareExchange((volatile LONG*)&r->seq, (LONG)LOG_SEQ_FREE(ulClaim + LOG_RING_RECORDS),
+                (LONG)ulFrom) == ulFrom) ? pdPASS : pdFAIL;
+}
+
+/* Print everything published in claim order. With xSkipStale, a slot claimed but still not
+   published after LOG_STALE_PASSES calls is given up and counted as dropped: the drain only
+   runs when every writer above it is blocked, and none blocks inside a record, so such a
+   slot belongs to a writer that was deleted between claim and publish. */
+static void prvDrain(BaseType_t xSkipStale) {
+    uint32_t ulTail = ulLogTail;
+
+    while (ulTail != ulLogHead) {
+        LogRecord* r = &xLogRing[ulTail & (LOG_RING_RECORDS - 1)];
+        if (r->seq == LOG_SEQ_PUBLISHED(ulTail)) {
+            prvPrintRecord(r);
+            (void)prvRelease(r, ulTail, LOG_SEQ_PUBLISHED(ulTail));
+        }
+        else {
+            // claimed, not published yet
+            if (xSkipStale == pdFALSE) {
+                break;
+            }
+            if (uxLogStalePasses == 0 || ulLogStaleClaim != ulTail) {
+                ulLogStaleClaim = ulTail;
+                uxLogStalePasses = 0;
+            }
+            if (++uxLogStalePasses < LOG_STALE_PASSES) {
+                break;
+            }
+            if (prvRelease(r, ulTail, LOG_SEQ_FREE(ulTail)) == pdFAIL) {
+                continue; // published just now after all
+            }
+            prvCountDrop();
+        }
+        uxLogStalePasses = 0;
+        MemoryBarrier();
+        ulLogTail = ++ulTail; // hand the slot back to the writers
+    }
+
+    uint32_t ulDropped = ulLogDropped;
+    if (ulDropped != ulLogDroppedReported) {
+        printf("[log] %lu records dropped (ring full or writer deleted)\n", (unsigned long)(ulDropped - ulLogDroppedReported));
+        ulLogDroppedReported = ulDropped;
+    }
+}
+
+void vLogFlush(void) {
+    prvDrain(pdFALSE);
+}
+
+uint32_t ulLogDroppedCount(void) {
+    return ulLogDropped;
+}
+
+static void vLogDrainTask(void* pvParameters) {
+    (void)pvParameters;
+    EventChannelEvents xEvents;
+    for (;;) {
+        prvDrain(pdTRUE);
+        // every LOG_DRAIN_PERIOD_MS, or sooner when asked to flush
+        (void)ulEventChannelWait(EVENT_CHANNEL_BIT(EVENT_CHANNEL_LOG_FLUSH), &xEvents, pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void vLogRequestFlush(void) {
+    if (xLogDrain != NULL) {
+        vEventChannelPost(xLogDrain, EVENT_CHANNEL_LOG_FLUSH, 1);
+    }
+}
+
+void vLogInit(void) {
+    for (UBaseType_t i = 0; i < LOG_FORMAT_COUNT; ++i) {
+        ucLogArgc[i] = (uint8_t)prvParseArgs(pcLogFormats[i], ucLogArgType[i], LOG_MAX_ARGS);
+    }
+    xTaskCreate(vLogDrainTask, "LogDrain", LOG_DRAIN_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xLogDrain);
+    vStackAuditRegister(xLogDrain, LOG_DRAIN_STACK_SIZE);
+}
@@ -0,0 +1,76 @@
+/* deferred_log.h
+   Non-blocking logger for the real-time demo tasks.
+   - the calling task only captures a compact binary record (tick, format, argument words)
+     into a bounded ring; nothing is formatted and no console I/O happens on its time
+   - the ring is multi-producer/single-consumer and lock-free: a slot is claimed with a
+     compare-and-swap on the head and published with one on its sequence number, so writers
+     never block, never take a critical section and never wait for ring space
+   - a writer deleted between claim and publish (e.g. by prvRestartWorker) leaves its slot
+     unpublished; the drain gives such a slot up after LOG_STALE_PASSES passes and counts it
+     as dropped. That is only safe because writers run above tskIDLE_PRIORITY and are never
+     suspended: while the idle-priority drain runs, no live writer can be inside a record
+   - a drain task at tskIDLE_PRIORITY formats and prints the records in claim order, every
+     LOG_DRAIN_PERIOD_MS or when vLogRequestFlush() posts to its log-flush event channel
+   - when the ring is full the record is dropped and counted instead of waiting
+   - with LOG_INTERNED_FORMATS the call sites in log_formats.h log by LogFormatId: a record
+     holds the 16-bit id and raw argument words, the argument types are worked out once in
+     vLogInit(), and the format string is only looked up by the drain task
+   Supported conversions: %d %i %u %x %X %o %c %s %p with the optional l, z or h length
+   modifiers; flags, width and precision are kept. %s arguments are stored by pointer, so
+   the string must outlive the record (literals and task names are fine).
+*/
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdarg.h>
+#include "FreeRTOS.h"
+#include "log_formats.h"
+
+/* 1: xLogEvent() stores the id and skips format parsing. 0: it logs the table's format
+   string through xLogVPrintf(), which is handy for comparing the two paths. */
+#ifndef LOG_INTERNED_FORMATS
+#define LOG_INTERNED_FORMATS 1
+#endif
+
+#ifndef LOG_RING_RECORDS
+#define LOG_RING_RECORDS 256 // must be a power of two
+#endif
+#define LOG_MAX_ARGS 6 // ad-hoc records spend one of these on the format pointer
+#define LOG_DRAIN_PERIOD_MS 20
+#define LOG_STALE_PASSES 3 // drain passes a claimed slot may stay unpublished before it is dropped
+#define LOG_DRAIN_STACK_SIZE (configMINIMAL_STACK_SIZE + 60)
+
+#define LOG_FORMAT_ENUM(id, fmt) id,
+typedef enum {
+    LOG_FORMAT_TABLE(LOG_FORMAT_ENUM)
+    LOG_FORMAT_COUNT,
+    LOG_FORMAT_ADHOC = 0xFFFF // record from xLogPrintf(), format pointer in the first word
+} LogFormatId;
+
+/* Create the drain task and prepare the format table. Call once before vTaskStartScheduler(). */
+void vLogInit(void);
+
+/* Capture a record for an interned format. Returns pdFAIL (and counts a drop) if the ring is full. */
+BaseType_t xLogEvent(LogFormatId id, ...);
+
+/* Format string behind an id, for offline decoders and the drain task. */
+const char* pcLogFormatString(LogFormatId id);
+
+/* Capture a record for a format that is not in the table. Returns pdFAIL (and counts a drop) if the ring is full. */
+BaseType_t xLogPrintf(const char* fmt, ...);
+BaseType_t xLogVPrintf(const char* fmt, va_list ap);
+
+/* Format and print everything published so far from the calling context, e.g. from an assert
+   handler that must flush before stopping. Stops at the first unpublished slot; only the
+   drain task gives stale slots up. */
+void vLogFlush(void);
+
+/* Wake the drain task now instead of at its next period, e.g. after logging a batch that
+   could otherwise fill the ring. The records are still printed at the drain's priority. */
+void vLogRequestFlush(void);
+
+/* Records lost because the ring was full or their writer was deleted mid-record. */
+uint32_t ulLogDroppedCount(void);
+
+#endif /* DEFERRED_LOG_H */
@@ -0,0 +1,166 @@
+/* edf_admission.c
+   Utilisation and processor-demand tests for EDF (see edf_admission.h).
+*/
+
+#include <stdio.h>
+#include "edf_admission.h"
+
+static uint64_t prvGcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t c = a % b;
+        a = b;
+        b = c;
+    }
+    return a;
+}
+
+/* Exact sum(C/T) <= 1 on reduced fractions; falls back to the rounded-up ppm figure if the
+   denominators would overflow. */
+static BaseType_t prvUtilisationFits(const EDFTaskSpec* pxTasks, UBaseType_t uxCount, uint64_t ullPpm) {
+    uint64_t ullNum = 0, ullDen = 1;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        uint64_t T = pxTasks[i].period, C = pxTasks[i].wcet;
+        uint64_t g = prvGcd(ullDen, T);
+        uint64_t ullScaleOld = T / g, ullScaleNew = ullDen / g;
+        if (ullDen > UINT64_MAX / ullScaleOld || ullNum > UINT64_MAX / ullScaleOld / 2 || C > UINT64_MAX / ullScaleNew / 2) {
+            return (ullPpm <= 1000000u) ? pdTRUE : pdFALSE;
+        }
+        ullNum = ullNum * ullScaleOld + C * ullScaleNew;
+        ullDen = ullDen * ullScaleOld;
+        g = prvGcd(ullNum, ullDen);
+        ullNum /= g;
+        ullDen /= g;
+        if (ullNum > ullDen) {
+            return pdFALSE;
+        }
+    }
+    return pdTRUE;
+}
+
+/* dbf(t): execution that must complete within any window of length t. */
+static uint64_t prvDemand(const EDFTaskSpec* pxTasks, UBaseType_t uxCount, uint64_t t) {
+    uint64_t ullDemand = 0;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        if (t >= pxTasks[i].deadline) {
+            ullDemand += ((t - pxTasks[i].deadline) / pxTasks[i].period + 1) * pxTasks[i].wcet;
+        }
+    }
+    return ullDemand;
+}
+
+/* Largest absolute deadline strictly before t, or 0 if there is none. */
+static uint64_t prvDeadlineBefore(const EDFTaskSpec* pxTasks, UBaseType_t uxCount, uint64_t t) {
+    uint64_t ullBest = 0;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        if (t > pxTasks[i].deadline) {
+            uint64_t d = ((t - pxTasks[i].deadline - 1) / pxTasks[i].period) * pxTasks[i].period + pxTasks[i].deadline;
+            if (d > ullBest) {
+                ullBest = d;
+            }
+        }
+    }
+    return ullBest;
+}
+
+/* Length of the synchronous busy period, or 0 if it did not converge in time. */
+static uint64_t prvBusyPeriod(const EDFTaskSpec* pxTasks, UBaseType_t uxCount) {
+    uint64_t w = 0, ullNext = 0;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        ullNext += pxTasks[i].wcet;
+    }
+    for (uint32_t n = 0; n < EDF_ADMISSION_MAX_ITERATIONS && ullNext != w; ++n) {
+        w = ullNext;
+        ullNext = 0;
+        for (UBaseType_t i = 0; i < uxCount; ++i) {
+            ullNext += ((w + pxTasks[i].period - 1) / pxTasks[i].period) * pxTasks[i].wcet;
+        }
+    }
+    return (ullNext == w) ? w : 0;
+}
+
+BaseType_t xEDFAdmissionTest(const EDFTaskSpec* pxTasks, UBaseType_t uxCount, EDFAdmissionReport* pxReport) {
+    EDFAdmissionReport xReport = { 0 };
+    BaseType_t xConstrained = pdFALSE;
+    double dUtilisation = 0.0, dSlackWeight = 0.0;
+    uint64_t ullMaxDeadline = 0, ullMinDeadline = UINT64_MAX, ullPpm = 0;
+
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        const EDFTaskSpec* t = &pxTasks[i];
+        configASSERT(t->period > 0 && t->deadline > 0);
+        ullPpm += ((uint64_t)t->wcet * 1000000u + t->period - 1) / t->period;
+        dUtilisation += (double)t->wcet / (double)t->period;
+        if (t->deadline < t->period) {
+            xConstrained = pdTRUE;
+            dSlackWeight += (double)(t->period - t->deadline) * t->wcet / t->period;
+        }
+        if (t->deadline > ullMaxDeadline) {
+            ullMaxDeadline = t->deadline;
+        }
+        if (t->deadline < ullMinDeadline) {
+            ullMinDeadline = t->deadline;
+        }
+    }
+
+    xReport.utilisationPpm = (ullPpm > UINT32_MAX) ? UINT32_MAX : (uint32_t)ullPpm;
+    xReport.utilisationOk = prvUtilisationFits(pxTasks, uxCount, ullPpm);
+    xReport.demandOk = xReport.utilisationOk;
+
+    if (xReport.utilisationOk == pdTRUE && xConstrained == pdTRUE) {
+        uint64_t L = prvBusyPeriod(pxTasks, uxCount);
+        if (dUtilisation < 1.0) {
+            double dLa = dSlackWeight / (1.0 - dUtilisation);
+            uint64_t ullLa = (dLa > (double)ullMaxDeadline) ? (uint64_t)dLa + 1 : ullMaxDeadline;
+            if (L == 0 || ullLa < L) {
+                L = ullLa;
+            }
+        }
+
+        xReport.demandOk = pdFALSE;
+        xReport.testedUpTo = L;
+        if (L != 0) {
+            // QPA: step back from the last deadline before L until the demand fits under d_min
+            uint64_t t = prvDeadlineBefore(pxTasks, uxCount, L + 1);
+            uint64_t h = prvDemand(pxTasks, uxCount, t);
+            uint32_t n = 0;
+            while (h <= t && h > ullMinDeadline && n++ < EDF_ADMISSION_MAX_ITERATIONS) {
+                t = (h < t) ? h : prvDeadlineBefore(pxTasks, uxCount, t);
+                h = prvDemand(pxTasks, uxCount, t);
+            }
+            if (h <= ullMinDeadline) {
+                xReport.demandOk = pdTRUE;
+            }
+            else if (h > t) {
+                xReport.failingInterval = t;
+                xReport.demandAtFailure = h;
+            }
+        }
+    }
+
+    if (pxReport != NULL) {
+        *pxReport = xReport;
+    }
+    return (xReport.utilisationOk == pdTRUE && xReport.demandOk == pdTRUE) ? pdPASS : pdFAIL;
+}
+
+void vEDFAdmissionPrint(const char* pcSetName, const EDFTaskSpec* pxTasks, UBaseType_t uxCount, const EDFAdmissionReport* pxReport) {
+    BaseType_t xOk = (pxReport->utilisationOk == pdTRUE && pxReport->demandOk == pdTRUE);
+
+    printf("Admission [%s]: %s, U=%lu.%06lu\r\n", pcSetName, xOk ? "schedulable" : "NOT schedulable",
+        (unsigned long)(pxReport->utilisationPpm / 1000000u), (unsigned long)(pxReport->utilisationPpm % 1000000u));
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        printf("  %-12s T=%lu D=%lu C=%lu\r\n", pxTasks[i].name, (unsigned long)pxTasks[i].period,
+            (unsigned long)pxTasks[i].deadline, (unsigned long)pxTasks[i].wcet);
+    }
+    if (pxReport->utilisationOk != pdTRUE) {
+        printf("  utilisation exceeds 1\r\n");
+    }
+    else if (pxReport->demandOk != pdTRUE) {
+        if (pxReport->failingInterval != 0) {
+            printf("  demand %llu exceeds interval %llu\r\n", (unsigned long long)pxReport->demandAtFailure,
+                (unsigned long long)pxReport->failingInterval);
+        }
+        else {
+            printf("  demand test did not converge (tested up to %llu)\r\n", (unsigned long long)pxReport->testedUpTo);
+        }
+    }
+}
@@ -0,0 +1,45 @@
+/* edf_admission.h
+   EDF schedulability tests run on a declared task set before the tasks are created.
+   - utilisation test: sum(C/T) <= 1, exact when every deadline is at least its period
+   - processor-demand test for constrained deadlines (D < T): QPA (Zhang & Burns) checks
+     dbf(t) <= t at the absolute deadlines up to the smaller of the synchronous busy period
+     and the L_a bound, walking backwards from the largest one
+   - all times are in ticks; WCETs are the budgets the task is allowed to consume per job
+*/
+
+#ifndef EDF_ADMISSION_H
+#define EDF_ADMISSION_H
+
+#include "FreeRTOS.h"
+
+/* 1: the demos refuse to start an infeasible task set. 0: they report it and start anyway. */
+#ifndef EDF_ADMISSION_REJECT
+#define EDF_ADMISSION_REJECT 0
+#endif
+
+/* Upper bound on busy-period and QPA iterations, so a pathological set cannot hang start-up. */
+#define EDF_ADMISSION_MAX_ITERATIONS 100000u
+
+typedef struct {
+    const char* name;
+    TickType_t period;
+    TickType_t deadline; // relative
+    TickType_t wcet;
+} EDFTaskSpec;
+
+typedef struct {
+    uint32_t utilisationPpm;   // sum(C/T) in parts per million, rounded up
+    BaseType_t utilisationOk;  // decided on exact fractions, not on the rounded figure
+    BaseType_t demandOk;       // pdFALSE also when the test gave up (EDF_ADMISSION_MAX_ITERATIONS)
+    uint64_t testedUpTo;       // length of the interval the demand test covered
+    uint64_t failingInterval;  // t with dbf(t) > t, 0 if none was found
+    uint64_t demandAtFailure;  // dbf(failingInterval)
+} EDFAdmissionReport;
+
+/* Returns pdPASS if the set is EDF schedulable on one processor. pxReport may be NULL. */
+BaseType_t xEDFAdmissionTest(const EDFTaskSpec* pxTasks, UBaseType_t uxCount, EDFAdmissionReport* pxReport);
+
+/* Print the verdict with printf. Meant for start-up, before the scheduler runs. */
+void vEDFAdmissionPrint(const char* pcSetName, const EDFTaskSpec* pxTasks, UBaseType_t uxCount, const EDFAdmissionReport* pxReport);
+
+#endif /* EDF_ADMISSION_H */
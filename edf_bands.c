@@ -0,0 +1,66 @@
+/* edf_bands.c
+   Deadline-rank to priority band mapping (see edf_bands.h).
+*/
+
+#include "edf_bands.h"
+
+void vEDFBandMapInit(EDFBandMap* m, UBaseType_t uxLowest, UBaseType_t uxHighest) {
+    configASSERT(uxLowest <= uxHighest);
+    m->highest = uxHighest;
+    m->bands = uxHighest - uxLowest + 1;
+    if (m->bands > EDF_BANDS_MAX) {
+        m->bands = EDF_BANDS_MAX;
+    }
+    m->tracked = (1u << (m->bands - 1)) - 1;
+    m->trackedCount = 0;
+    m->priorityChanges = 0;
+    for (UBaseType_t i = 0; i < EDF_QUEUE_MAX_ITEMS; ++i) {
+        m->band[i] = (uint8_t)(m->bands - 1);
+    }
+}
+
+UBaseType_t uxEDFBandForRank(const EDFBandMap* m, UBaseType_t uxRank) {
+    UBaseType_t uxBand = 0;
+    // floor(log2(rank + 1)), saturating at the lowest band
+    for (UBaseType_t uxSpan = uxRank + 1; uxSpan > 1 && uxBand < m->bands - 1; uxSpan >>= 1) {
+        uxBand++;
+    }
+    return uxBand;
+}
+
+static UBaseType_t prvSetBand(EDFBandMap* m, UBaseType_t uxItem, UBaseType_t uxBand, EDFSetPriorityFunction_t pxSetPriority) {
+    if (m->band[uxItem] == uxBand) {
+        return 0;
+    }
+    m->band[uxItem] = (uint8_t)uxBand;
+    pxSetPriority(uxItem, uxEDFBandPriority(m, uxBand));
+    m->priorityChanges++;
+    return 1;
+}
+
+UBaseType_t uxEDFBandMapApply(EDFBandMap* m, EDFQueue* q, EDFSetPriorityFunction_t pxSetPriority) {
+    UBaseType_t uxCount = 0, uxChanges = 0, uxItem;
+
+    // take the earliest deadlines out of the heap in rank order
+    while (uxCount < m->tracked && xEDFQueuePeekMin(q, &uxItem) == pdPASS) {
+        m->poppedKey[uxCount] = xEDFQueueKey(q, uxItem);
+        xEDFQueuePopMin(q, &uxItem);
+        m->popped[uxCount++] = (uint16_t)uxItem;
+    }
+
+    // anything tracked last time that is still queued has dropped out of the tracked ranks
+    for (UBaseType_t i = 0; i < m->trackedCount; ++i) {
+        if (xEDFQueueContains(q, m->trackedItems[i]) == pdTRUE) {
+            uxChanges += prvSetBand(m, m->trackedItems[i], m->bands - 1, pxSetPriority);
+        }
+    }
+
+    for (UBaseType_t r = 0; r < uxCount; ++r) {
+        uxChanges += prvSetBand(m, m->popped[r], uxEDFBandForRank(m, r), pxSetPriority);
+        xEDFQueueInsert(q, m->popped[r], m->poppedKey[r]);
+        m->trackedItems[r] = m->popped[r];
+    }
+    m->trackedCount = uxCount;
+
+    return uxChanges;
+}
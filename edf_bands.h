@@ -0,0 +1,59 @@
+/* edf_bands.h
+   EDF-to-priority mapping for a kernel with few priority levels.
+   - deadline rank is compressed into bands on a log2 scale: rank 0 gets the highest band,
+     ranks 1-2 the next, 3-6 the next, ... and every rank past the last tracked one shares
+     the lowest band
+   - the priorities above the highest band are left to the EDF scheduler and the timer
+     daemon (configTIMER_TASK_PRIORITY), so EDF tasks can never alias them
+   - a priority is only written when a task's band actually changes
+*/
+
+#ifndef EDF_BANDS_H
+#define EDF_BANDS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "edf_queue.h"
+
+/* Highest priority handed to an EDF task; everything above is reserved. */
+#define EDF_BAND_HIGHEST_PRIORITY (configMAX_PRIORITIES - 2)
+#define EDF_BAND_LOWEST_PRIORITY (tskIDLE_PRIORITY + 1)
+
+/* Cap on the number of bands, which bounds the ranks tracked per pass to 2^(bands-1) - 1. */
+#define EDF_BANDS_MAX 7
+#define EDF_BANDS_MAX_TRACKED ((1u << (EDF_BANDS_MAX - 1)) - 1)
+
+#if (configTIMER_TASK_PRIORITY <= EDF_BAND_HIGHEST_PRIORITY)
+#error "The timer daemon must sit above the EDF priority bands"
+#endif
+
+/* Called for every task whose band changed; normally wraps vTaskPrioritySet(). */
+typedef void (*EDFSetPriorityFunction_t)(UBaseType_t uxItem, UBaseType_t uxPriority);
+
+typedef struct {
+    UBaseType_t highest;   // priority of band 0
+    UBaseType_t bands;     // number of bands in use
+    UBaseType_t tracked;   // deadline ranks that are looked at on each pass
+    uint16_t trackedItems[EDF_BANDS_MAX_TRACKED]; // items tracked on the last pass
+    UBaseType_t trackedCount;
+    uint16_t popped[EDF_BANDS_MAX_TRACKED];       // scratch for a pass, kept off the caller's stack
+    TickType_t poppedKey[EDF_BANDS_MAX_TRACKED];
+    uint8_t band[EDF_QUEUE_MAX_ITEMS];            // band each item currently has
+    uint32_t priorityChanges;                     // total vTaskPrioritySet() calls issued
+} EDFBandMap;
+
+/* Use priorities uxLowest..uxHighest (inclusive). All items start in the lowest band, so
+   tasks should be created at uxLowest. */
+void vEDFBandMapInit(EDFBandMap* m, UBaseType_t uxLowest, UBaseType_t uxHighest);
+
+UBaseType_t uxEDFBandForRank(const EDFBandMap* m, UBaseType_t uxRank);
+
+static inline UBaseType_t uxEDFBandPriority(const EDFBandMap* m, UBaseType_t uxBand) {
+    return m->highest - uxBand;
+}
+
+/* Re-derive the bands from the current order of q and call pxSetPriority for the items whose
+   band moved. Costs O(tracked * log N); q is left unchanged. Returns the number of changes. */
+UBaseType_t uxEDFBandMapApply(EDFBandMap* m, EDFQueue* q, EDFSetPriorityFunction_t pxSetPriority);
+
+#endif /* EDF_BANDS_H */
@@ -0,0 +1,101 @@
+/* edf_partition.c
+   First-fit-decreasing packing for partitioned EDF (see edf_partition.h).
+*/
+
+#include <stdio.h>
+#include "edf_partition.h"
+
+static UBaseType_t uxOrder[EDF_PARTITION_MAX_TASKS];
+static EDFTaskSpec xCandidate[EDF_PARTITION_MAX_TASKS];
+
+/* pdTRUE if a goes before b: larger C/T first, compared cross-multiplied. */
+static BaseType_t prvHeavier(const EDFTaskSpec* a, const EDFTaskSpec* b) {
+    uint64_t ullA = (uint64_t)a->wcet * b->period;
+    uint64_t ullB = (uint64_t)b->wcet * a->period;
+    if (ullA != ullB) {
+        return (ullA > ullB) ? pdTRUE : pdFALSE;
+    }
+    return (a->deadline < b->deadline) ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxEDFPartitionMembers(const EDFPartitionPlan* pxPlan, UBaseType_t uxCount,
+    UBaseType_t uxPartition, UBaseType_t* puxIndices) {
+    UBaseType_t n = 0;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        if (pxPlan->assignment[i] == uxPartition) {
+            puxIndices[n++] = i;
+        }
+    }
+    return n;
+}
+
+BaseType_t xEDFPartitionFirstFitDecreasing(const EDFTaskSpec* pxTasks, UBaseType_t uxCount,
+    UBaseType_t uxPartitions, EDFPartitionPlan* pxPlan) {
+    configASSERT(uxCount <= EDF_PARTITION_MAX_TASKS);
+    configASSERT(uxPartitions > 0 && uxPartitions <= EDF_PARTITION_MAX);
+
+    pxPlan->partitions = uxPartitions;
+    pxPlan->unassigned = 0;
+    for (UBaseType_t p = 0; p < EDF_PARTITION_MAX; ++p) {
+        pxPlan->count[p] = 0;
+        pxPlan->utilisationPpm[p] = 0;
+    }
+
+    // insertion sort by decreasing utilisation; sets are small and this runs once
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        UBaseType_t j = i;
+        while (j > 0 && prvHeavier(&pxTasks[i], &pxTasks[uxOrder[j - 1]]) == pdTRUE) {
+            uxOrder[j] = uxOrder[j - 1];
+            --j;
+        }
+        uxOrder[j] = i;
+        pxPlan->assignment[i] = EDF_PARTITION_NONE;
+    }
+
+    for (UBaseType_t k = 0; k < uxCount; ++k) {
+        UBaseType_t uxTask = uxOrder[k];
+        for (UBaseType_t p = 0; p < uxPartitions; ++p) {
+            // the partition as it is, plus this task
+            UBaseType_t n = 0;
+            for (UBaseType_t i = 0; i < uxCount; ++i) {
+                if (pxPlan->assignment[i] == p) {
+                    xCandidate[n++] = pxTasks[i];
+                }
+            }
+            xCandidate[n++] = pxTasks[uxTask];
+
+            EDFAdmissionReport xReport;
+            if (xEDFAdmissionTest(xCandidate, n, &xReport) == pdPASS) {
+                pxPlan->assignment[uxTask] = (uint8_t)p;
+                pxPlan->count[p]++;
+                pxPlan->utilisationPpm[p] = xReport.utilisationPpm;
+                break;
+            }
+        }
+        if (pxPlan->assignment[uxTask] == EDF_PARTITION_NONE) {
+            pxPlan->unassigned++;
+        }
+    }
+    return (pxPlan->unassigned == 0) ? pdPASS : pdFAIL;
+}
+
+void vEDFPartitionPrint(const char* pcSetName, const EDFTaskSpec* pxTasks, UBaseType_t uxCount,
+    const EDFPartitionPlan* pxPlan) {
+    printf("Partitions [%s]: %lu tasks on %lu processors, %lu unassigned\r\n", pcSetName,
+        (unsigned long)uxCount, (unsigned long)pxPlan->partitions, (unsigned long)pxPlan->unassigned);
+    for (UBaseType_t p = 0; p < pxPlan->partitions; ++p) {
+        printf("  P%lu U=%lu.%06lu:", (unsigned long)p,
+            (unsigned long)(pxPlan->utilisationPpm[p] / 1000000u), (unsigned long)(pxPlan->utilisationPpm[p] % 1000000u));
+        for (UBaseType_t i = 0; i < uxCount; ++i) {
+            if (pxPlan->assignment[i] == p) {
+                printf(" %s", pxTasks[i].name);
+            }
+        }
+        printf("\r\n");
+    }
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        if (pxPlan->assignment[i] == EDF_PARTITION_NONE) {
+            printf("  unassigned: %s\r\n", pxTasks[i].name);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/* edf_partition.h
+   Partitioned EDF: static assignment of a task set to processors.
+   - first-fit decreasing: tasks are taken by decreasing utilisation C/T (ties: shorter
+     deadline first) and each goes to the lowest-numbered partition that stays schedulable
+     with it under the full admission test (edf_admission.h), so constrained deadlines are
+     checked by processor demand, not only by the utilisation bound
+   - nothing migrates afterwards: every partition is a uniprocessor EDF problem of its own
+     and is run by its own scheduler instance
+   - a task that fits in no partition is left unassigned (EDF_PARTITION_NONE) and the
+     assignment as a whole fails
+   Meant for start-up, before the scheduler runs: the candidate sets are built in static
+   scratch memory.
+*/
+
+#ifndef EDF_PARTITION_H
+#define EDF_PARTITION_H
+
+#include "FreeRTOS.h"
+#include "edf_admission.h"
+
+#define EDF_PARTITION_MAX 8
+#define EDF_PARTITION_MAX_TASKS 200 // the largest benchmark case
+#define EDF_PARTITION_NONE 0xFFu
+
+typedef struct {
+    UBaseType_t partitions;                       // processors the set was packed onto
+    uint8_t assignment[EDF_PARTITION_MAX_TASKS];  // partition of each task, in input order
+    UBaseType_t count[EDF_PARTITION_MAX];         // tasks per partition
+    uint32_t utilisationPpm[EDF_PARTITION_MAX];   // sum(C/T) per partition, rounded up
+    UBaseType_t unassigned;                       // tasks that fit nowhere
+} EDFPartitionPlan;
+
+/* Pack pxTasks onto uxPartitions processors. Returns pdPASS if every task was placed. */
+BaseType_t xEDFPartitionFirstFitDecreasing(const EDFTaskSpec* pxTasks, UBaseType_t uxCount,
+    UBaseType_t uxPartitions, EDFPartitionPlan* pxPlan);
+
+/* Input positions of the tasks of uxPartition, in input order, into puxIndices (room for
+   EDF_PARTITION_MAX_TASKS). Returns how many there are. */
+UBaseType_t uxEDFPartitionMembers(const EDFPartitionPlan* pxPlan, UBaseType_t uxCount,
+    UBaseType_t uxPartition, UBaseType_t* puxIndices);
+
+/* Print the plan with printf. */
+void vEDFPartitionPrint(const char* pcSetName, const EDFTaskSpec* pxTasks, UBaseType_t uxCount,
+    const EDFPartitionPlan* pxPlan);
+
+#endif /* EDF_PARTITION_H */
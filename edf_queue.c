@@ -0,0 +1,113 @@
+/* edf_queue.c
+   Indexed binary min-heap used by the EDF schedulers (see edf_queue.h).
+*/
+
+#include "edf_queue.h"
+
+/* Order by deadline, ties by item index so equal deadlines always pop in the same order. */
+static int prvEarlier(const EDFQueue* q, uint16_t usA, uint16_t usB) {
+    return (q->key[usA] < q->key[usB]) || (q->key[usA] == q->key[usB] && usA < usB);
+}
+
+static void prvPlace(EDFQueue* q, UBaseType_t uxSlot, uint16_t usItem) {
+    q->heap[uxSlot] = usItem;
+    q->slot[usItem] = (uint16_t)uxSlot;
+}
+
+static void prvSiftUp(EDFQueue* q, UBaseType_t uxSlot) {
+    uint16_t usItem = q->heap[uxSlot];
+    while (uxSlot > 0) {
+        UBaseType_t uxParent = (uxSlot - 1) / 2;
+        if (!prvEarlier(q, usItem, q->heap[uxParent])) {
+            break;
+        }
+        prvPlace(q, uxSlot, q->heap[uxParent]);
+        uxSlot = uxParent;
+    }
+    prvPlace(q, uxSlot, usItem);
+}
+
+static void prvSiftDown(EDFQueue* q, UBaseType_t uxSlot) {
+    uint16_t usItem = q->heap[uxSlot];
+    for (;;) {
+        UBaseType_t uxChild = 2 * uxSlot + 1;
+        if (uxChild >= q->count) {
+            break;
+        }
+        if (uxChild + 1 < q->count && prvEarlier(q, q->heap[uxChild + 1], q->heap[uxChild])) {
+            uxChild++;
+        }
+        if (!prvEarlier(q, q->heap[uxChild], usItem)) {
+            break;
+        }
+        prvPlace(q, uxSlot, q->heap[uxChild]);
+        uxSlot = uxChild;
+    }
+    prvPlace(q, uxSlot, usItem);
+}
+
+void vEDFQueueInit(EDFQueue* q) {
+    q->count = 0;
+    for (UBaseType_t i = 0; i < EDF_QUEUE_MAX_ITEMS; ++i) {
+        q->slot[i] = EDF_QUEUE_NOT_QUEUED;
+    }
+}
+
+BaseType_t xEDFQueueInsert(EDFQueue* q, UBaseType_t uxItem, TickType_t xDeadline) {
+    if (uxItem >= EDF_QUEUE_MAX_ITEMS || q->slot[uxItem] != EDF_QUEUE_NOT_QUEUED) {
+        return pdFAIL;
+    }
+    q->key[uxItem] = xDeadline;
+    prvPlace(q, q->count, (uint16_t)uxItem);
+    q->count++;
+    prvSiftUp(q, q->count - 1);
+    return pdPASS;
+}
+
+BaseType_t xEDFQueueUpdate(EDFQueue* q, UBaseType_t uxItem, TickType_t xDeadline) {
+    if (xEDFQueueContains(q, uxItem) == pdFALSE) {
+        return pdFAIL;
+    }
+    TickType_t xOld = q->key[uxItem];
+    q->key[uxItem] = xDeadline;
+    if (xDeadline < xOld) {
+        prvSiftUp(q, q->slot[uxItem]); // decrease-key
+    }
+    else if (xDeadline > xOld) {
+        prvSiftDown(q, q->slot[uxItem]);
+    }
+    return pdPASS;
+}
+
+BaseType_t xEDFQueueRemove(EDFQueue* q, UBaseType_t uxItem) {
+    if (xEDFQueueContains(q, uxItem) == pdFALSE) {
+        return pdFAIL;
+    }
+    UBaseType_t uxSlot = q->slot[uxItem];
+    q->slot[uxItem] = EDF_QUEUE_NOT_QUEUED;
+    q->count--;
+    if (uxSlot < q->count) {
+        // fill the hole with the last leaf, which may need to move either way
+        uint16_t usMoved = q->heap[q->count];
+        prvPlace(q, uxSlot, usMoved);
+        prvSiftDown(q, uxSlot);
+        prvSiftUp(q, q->slot[usMoved]);
+    }
+    return pdPASS;
+}
+
+BaseType_t xEDFQueuePeekMin(const EDFQueue* q, UBaseType_t* puxItem) {
+    if (q->count == 0) {
+        return pdFAIL;
+    }
+    *puxItem = q->heap[0];
+    return pdPASS;
+}
+
+BaseType_t xEDFQueuePopMin(EDFQueue* q, UBaseType_t* puxItem) {
+    if (q->count == 0) {
+        return pdFAIL;
+    }
+    *puxItem = q->heap[0];
+    return xEDFQueueRemove(q, *puxItem);
+}
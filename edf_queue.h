@@ -0,0 +1,53 @@
+/* edf_queue.h
+   Deadline-ordered priority queue for the EDF demos.
+   - indexed binary min-heap keyed on absolute deadline (TickType_t), ties broken by item index
+   - stores item indices (e.g. positions in edfTasks[]), never copies of the task structs
+   - insert, key update (decrease or increase) and pop-min are O(log N), peek is O(1)
+   - storage is part of the structure, so no heap allocation is needed
+*/
+
+#ifndef EDF_QUEUE_H
+#define EDF_QUEUE_H
+
+#include "FreeRTOS.h"
+
+/* Maximum number of items a single queue can hold; item indices must be below it. */
+#ifndef EDF_QUEUE_MAX_ITEMS
+#define EDF_QUEUE_MAX_ITEMS 256
+#endif
+
+#define EDF_QUEUE_NOT_QUEUED 0xFFFFu
+
+typedef struct {
+    uint16_t heap[EDF_QUEUE_MAX_ITEMS];   // heap slot -> item
+    uint16_t slot[EDF_QUEUE_MAX_ITEMS];   // item -> heap slot, EDF_QUEUE_NOT_QUEUED if absent
+    TickType_t key[EDF_QUEUE_MAX_ITEMS];  // item -> deadline it is ordered by
+    UBaseType_t count;
+} EDFQueue;
+
+void vEDFQueueInit(EDFQueue* q);
+
+/* Insert an item that is not queued yet. Returns pdFAIL if the item index is out of range or already queued. */
+BaseType_t xEDFQueueInsert(EDFQueue* q, UBaseType_t uxItem, TickType_t xDeadline);
+
+/* Move a queued item to a new deadline; earlier deadlines sift up (decrease-key), later ones sift down. */
+BaseType_t xEDFQueueUpdate(EDFQueue* q, UBaseType_t uxItem, TickType_t xDeadline);
+
+/* Remove a queued item wherever it is in the heap. */
+BaseType_t xEDFQueueRemove(EDFQueue* q, UBaseType_t uxItem);
+
+/* Earliest-deadline item without removing it. Returns pdFAIL when the queue is empty. */
+BaseType_t xEDFQueuePeekMin(const EDFQueue* q, UBaseType_t* puxItem);
+
+/* Remove and return the earliest-deadline item. Returns pdFAIL when the queue is empty. */
+BaseType_t xEDFQueuePopMin(EDFQueue* q, UBaseType_t* puxItem);
+
+static inline BaseType_t xEDFQueueContains(const EDFQueue* q, UBaseType_t uxItem) {
+    return (uxItem < EDF_QUEUE_MAX_ITEMS && q->slot[uxItem] != EDF_QUEUE_NOT_QUEUED) ? pdTRUE : pdFALSE;
+}
+
+static inline TickType_t xEDFQueueKey(const EDFQueue* q, UBaseType_t uxItem) {
+    return q->key[uxItem];
+}
+
+#endif /* EDF_QUEUE_H */
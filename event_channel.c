@@ -0,0 +1,59 @@
+/* event_channel.c
+   Doorbell and per-channel notification indices (see event_channel.h).
+*/
+
+#include "event_channel.h"
+
+#define EVENT_CHANNEL_DOORBELL 0
+
+void vEventChannelPost(TaskHandle_t xTask, EventChannel xChannel, uint32_t ulBits) {
+    configASSERT(xChannel > EVENT_CHANNEL_DOORBELL && xChannel < EVENT_CHANNEL_COUNT);
+    xTaskNotifyIndexed(xTask, xChannel, ulBits, eSetBits);
+    xTaskNotifyIndexed(xTask, EVENT_CHANNEL_DOORBELL, EVENT_CHANNEL_BIT(xChannel), eSetBits);
+}
+
+void vEventChannelPostFromISR(TaskHandle_t xTask, EventChannel xChannel, uint32_t ulBits, BaseType_t* pxHigherPriorityTaskWoken) {
+    configASSERT(xChannel > EVENT_CHANNEL_DOORBELL && xChannel < EVENT_CHANNEL_COUNT);
+    xTaskNotifyIndexedFromISR(xTask, xChannel, ulBits, eSetBits, pxHigherPriorityTaskWoken);
+    xTaskNotifyIndexedFromISR(xTask, EVENT_CHANNEL_DOORBELL, EVENT_CHANNEL_BIT(xChannel), eSetBits, pxHigherPriorityTaskWoken);
+}
+
+uint32_t ulEventChannelWait(uint32_t ulMask, EventChannelEvents* pxEvents, TickType_t xTicksToWait) {
+    TimeOut_t xTimeOut;
+    uint32_t ulDrained = 0;
+
+    for (UBaseType_t c = 0; c < EVENT_CHANNEL_COUNT; ++c) {
+        pxEvents->value[c] = 0;
+    }
+
+    vTaskSetTimeOutState(&xTimeOut);
+    for (;;) {
+        // only the waited-for doorbell bits are cleared; the others stay for a later wait.
+        // Bits already set are taken without blocking: a wait with another mask may have
+        // consumed the pending state while leaving them in the value.
+        uint32_t ulRung = ulTaskNotifyValueClearIndexed(NULL, EVENT_CHANNEL_DOORBELL, ulMask) & ulMask;
+        if (ulRung == 0) {
+            (void)xTaskNotifyWaitIndexed(EVENT_CHANNEL_DOORBELL, 0, ulMask, &ulRung, xTicksToWait);
+            ulRung &= ulMask;
+        }
+
+        while (ulRung != 0) {
+            UBaseType_t c = 0;
+            while ((ulRung & EVENT_CHANNEL_BIT(c)) == 0) {
+                ++c;
+            }
+            ulRung &= ~EVENT_CHANNEL_BIT(c);
+
+            // an earlier wait may already have drained what this bit announced
+            uint32_t ulBits = ulTaskNotifyValueClearIndexed(NULL, c, UINT32_MAX);
+            if (ulBits != 0) {
+                pxEvents->value[c] |= ulBits;
+                ulDrained |= EVENT_CHANNEL_BIT(c);
+            }
+        }
+
+        if (ulDrained != 0 || xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE) {
+            return ulDrained;
+        }
+    }
+}
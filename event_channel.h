@@ -0,0 +1,45 @@
+/* event_channel.h
+   Event channels on the indexed task notification array.
+   - notification index 0 is the task's doorbell: one bit per channel with events pending
+   - each channel owns the index of the same number and accumulates its events there as
+     bits (eSetBits), so one channel carries up to 32 distinct event flags
+   - posting sets the channel's bits first and then rings its doorbell bit
+   - ulEventChannelWait() blocks once on the doorbell for any channel in a mask and hands
+     back, per channel, everything that accumulated since the last wait: a burst of events
+     costs one wake, not one wake per event
+   - events on channels outside the mask stay pending for a later wait
+   A task that waits on channels must not use notification index 0 for anything else.
+*/
+
+#ifndef EVENT_CHANNEL_H
+#define EVENT_CHANNEL_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef enum {
+    EVENT_CHANNEL_HEARTBEAT = 1, // watchdog worker heartbeats, one bit per worker
+    EVENT_CHANNEL_RELEASE,       // a job was released or handed over
+    EVENT_CHANNEL_CANCEL,        // a job was cancelled or must stop
+    EVENT_CHANNEL_LOG_FLUSH,     // drain the deferred log now
+    EVENT_CHANNEL_COUNT          // one past the last channel
+} EventChannel;
+
+#if (EVENT_CHANNEL_COUNT > configTASK_NOTIFICATION_ARRAY_ENTRIES)
+#error "Every event channel needs its own notification index after the doorbell"
+#endif
+
+#define EVENT_CHANNEL_BIT(c) (1UL << (c))
+
+typedef struct {
+    uint32_t value[EVENT_CHANNEL_COUNT]; // bits drained per channel, 0 if none
+} EventChannelEvents;
+
+void vEventChannelPost(TaskHandle_t xTask, EventChannel xChannel, uint32_t ulBits);
+void vEventChannelPostFromISR(TaskHandle_t xTask, EventChannel xChannel, uint32_t ulBits, BaseType_t* pxHigherPriorityTaskWoken);
+
+/* Wait up to xTicksToWait for events on any channel in ulMask (EVENT_CHANNEL_BIT()s) and
+   drain them all into pxEvents. Returns the mask of channels that had events, 0 on timeout. */
+uint32_t ulEventChannelWait(uint32_t ulMask, EventChannelEvents* pxEvents, TickType_t xTicksToWait);
+
+#endif /* EVENT_CHANNEL_H */
@@ -0,0 +1,189 @@
+/* heap_stats.c
+   Incremental per-region heap_5 accounting (see heap_stats.h).
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_stats.h"
+
+// mirrors heap_4/heap_5: BlockLink_t { next; size } rounded up to portBYTE_ALIGNMENT,
+// with the top bit of the size marking an allocated block
+#define HEAP_STRUCT_SIZE ((sizeof(void*) + sizeof(size_t) + portBYTE_ALIGNMENT - 1) & ~((size_t)portBYTE_ALIGNMENT - 1))
+#define HEAP_BLOCK_ALLOCATED_BIT ((size_t)1 << (sizeof(size_t) * 8 - 1))
+#define HEAP_ALIGN_UP(x) (((x) + portBYTE_ALIGNMENT - 1) & ~((size_t)portBYTE_ALIGNMENT - 1))
+#define HEAP_ALIGN_DOWN(x) ((x) & ~((size_t)portBYTE_ALIGNMENT - 1))
+
+#if ((HEAP_STATS_MAX_GRANULES & (HEAP_STATS_MAX_GRANULES - 1)) != 0) || (HEAP_STATS_MAX_GRANULES > 65535)
+#error "HEAP_STATS_MAX_GRANULES must be a power of two that fits the 16-bit run lengths"
+#endif
+
+typedef struct {
+    uint16_t prefix; // free granules at the start of the node's span
+    uint16_t suffix; // free granules at its end
+    uint16_t best;   // longest run of free granules inside it
+} HeapRun;
+
+typedef struct {
+    uint8_t* start;            // first block of the region as heap_5 aligned it
+    uint8_t* end;              // heap_5's end marker
+    UBaseType_t leaves;        // granules rounded up to a power of two
+    HeapRegionStats stats;
+    HeapRun node[2 * HEAP_STATS_MAX_GRANULES];     // node[1] is the root, leaves from node[leaves]
+    uint8_t used[HEAP_STATS_MAX_GRANULES];         // allocated bytes in each granule
+} HeapRegionState;
+
+static HeapRegionState xRegions[HEAP_STATS_MAX_REGIONS];
+static UBaseType_t uxRegionCount = 0;
+static uint32_t ulFailedAllocations = 0;
+
+static void prvCombine(HeapRun* parent, const HeapRun* l, const HeapRun* r, uint16_t usHalf) {
+    parent->prefix = (l->prefix == usHalf) ? (uint16_t)(usHalf + r->prefix) : l->prefix;
+    parent->suffix = (r->suffix == usHalf) ? (uint16_t)(usHalf + l->suffix) : r->suffix;
+    uint16_t usBest = (l->best > r->best) ? l->best : r->best;
+    uint16_t usMiddle = (uint16_t)(l->suffix + r->prefix);
+    parent->best = (usMiddle > usBest) ? usMiddle : usBest;
+}
+
+/* Recompute the ancestors of leaves [uxFirst, uxLast]. Each level up covers half as many
+   nodes, so the cost is about twice the number of leaves plus the tree height. */
+static void prvRebuild(HeapRegionState* s, UBaseType_t uxFirst, UBaseType_t uxLast) {
+    UBaseType_t lo = s->leaves + uxFirst, hi = s->leaves + uxLast;
+    uint16_t usHalf = 1;
+    while (lo > 1) {
+        lo >>= 1;
+        hi >>= 1;
+        for (UBaseType_t i = lo; i <= hi; ++i) {
+            prvCombine(&s->node[i], &s->node[2 * i], &s->node[2 * i + 1], usHalf);
+        }
+        usHalf = (uint16_t)(usHalf * 2);
+    }
+}
+
+static void prvSetLeaf(HeapRegionState* s, UBaseType_t uxGranule) {
+    uint16_t usFree = (s->used[uxGranule] == 0) ? 1 : 0;
+    HeapRun* leaf = &s->node[s->leaves + uxGranule];
+    leaf->prefix = leaf->suffix = leaf->best = usFree;
+}
+
+static void prvRefreshDerived(HeapRegionState* s) {
+    HeapRegionStats* st = &s->stats;
+    st->largestFreeBlock = (size_t)s->node[1].best * HEAP_STATS_GRANULE;
+    if (st->largestFreeBlock > st->freeBytes) {
+        st->largestFreeBlock = st->freeBytes;
+    }
+    st->fragmentationPermille = (st->freeBytes == 0) ? 0
+        : (uint32_t)(1000 - (st->largestFreeBlock * 1000) / st->freeBytes);
+}
+
+/* Add (lSign = 1) or remove (-1) the bytes [pucBlock, pucBlock + xBytes) from the granules. */
+static void prvMark(HeapRegionState* s, uint8_t* pucBlock, size_t xBytes, int lSign) {
+    size_t xOffset = (size_t)(pucBlock - s->start);
+    size_t xEnd = xOffset + xBytes;
+    UBaseType_t uxFirst = (UBaseType_t)(xOffset / HEAP_STATS_GRANULE);
+    UBaseType_t uxLast = (UBaseType_t)((xEnd - 1) / HEAP_STATS_GRANULE);
+
+    for (UBaseType_t g = uxFirst; g <= uxLast; ++g) {
+        size_t xFrom = (g == uxFirst) ? xOffset : (size_t)g * HEAP_STATS_GRANULE;
+        size_t xTo = (g == uxLast) ? xEnd : (size_t)(g + 1) * HEAP_STATS_GRANULE;
+        s->used[g] = (uint8_t)(s->used[g] + lSign * (int)(xTo - xFrom));
+        prvSetLeaf(s, g);
+    }
+    prvRebuild(s, uxFirst, uxLast);
+}
+
+static HeapRegionState* prvRegionOf(const uint8_t* pucAddress) {
+    for (UBaseType_t r = 0; r < uxRegionCount; ++r) {
+        if (pucAddress >= xRegions[r].start && pucAddress < xRegions[r].end) {
+            return &xRegions[r];
+        }
+    }
+    return NULL;
+}
+
+void vHeapStatsInit(const HeapRegion_t* pxRegions) {
+    for (uxRegionCount = 0; pxRegions[uxRegionCount].xSizeInBytes > 0; ++uxRegionCount) {
+        configASSERT(uxRegionCount < HEAP_STATS_MAX_REGIONS);
+        HeapRegionState* s = &xRegions[uxRegionCount];
+
+        // the same layout vPortDefineHeapRegions() works out
+        size_t xStart = (size_t)pxRegions[uxRegionCount].pucStartAddress;
+        size_t xAligned = HEAP_ALIGN_UP(xStart);
+        size_t xEnd = HEAP_ALIGN_DOWN(xStart + pxRegions[uxRegionCount].xSizeInBytes - HEAP_STRUCT_SIZE);
+        s->start = (uint8_t*)xAligned;
+        s->end = (uint8_t*)xEnd;
+
+        size_t xFree = xEnd - xAligned;
+        UBaseType_t uxWhole = (UBaseType_t)(xFree / HEAP_STATS_GRANULE);
+        // the tree spans the partial tail granule too, since blocks can reach into it
+        UBaseType_t uxGranules = (UBaseType_t)((xFree + HEAP_STATS_GRANULE - 1) / HEAP_STATS_GRANULE);
+        configASSERT(uxGranules <= HEAP_STATS_MAX_GRANULES);
+        for (s->leaves = 1; s->leaves < uxGranules; s->leaves *= 2) {
+        }
+
+        // whole granules start free; the partial tail and the padding never count as free
+        for (UBaseType_t g = 0; g < s->leaves; ++g) {
+            s->used[g] = (g < uxWhole) ? 0 : 1;
+            prvSetLeaf(s, g);
+        }
+        prvRebuild(s, 0, s->leaves - 1);
+
+        s->stats.totalBytes = s->stats.freeBytes = s->stats.minimumEverFreeBytes = xFree;
+        prvRefreshDerived(s);
+    }
+}
+
+void vHeapStatsOnMalloc(void* pvAddress, size_t xSize) {
+    (void)xSize;
+    if (pvAddress == NULL) {
+        ulFailedAllocations++;
+        return;
+    }
+    uint8_t* pucBlock = (uint8_t*)pvAddress - HEAP_STRUCT_SIZE;
+    HeapRegionState* s = prvRegionOf(pucBlock);
+    if (s == NULL) {
+        return;
+    }
+    size_t xBlockSize = ((size_t*)pucBlock)[1] & ~HEAP_BLOCK_ALLOCATED_BIT;
+
+    s->stats.freeBytes -= xBlockSize;
+    if (s->stats.freeBytes < s->stats.minimumEverFreeBytes) {
+        s->stats.minimumEverFreeBytes = s->stats.freeBytes;
+    }
+    s->stats.allocations++;
+    prvMark(s, pucBlock, xBlockSize, 1);
+    prvRefreshDerived(s);
+}
+
+void vHeapStatsOnFree(void* pvAddress, size_t xSize) {
+    // heap_5 reports the block size here, with the allocated bit already cleared
+    if (pvAddress == NULL) {
+        return;
+    }
+    uint8_t* pucBlock = (uint8_t*)pvAddress - HEAP_STRUCT_SIZE;
+    HeapRegionState* s = prvRegionOf(pucBlock);
+    if (s == NULL) {
+        return;
+    }
+    s->stats.freeBytes += xSize;
+    s->stats.frees++;
+    prvMark(s, pucBlock, xSize, -1);
+    prvRefreshDerived(s);
+}
+
+BaseType_t xHeapStatsGetRegion(UBaseType_t uxRegion, HeapRegionStats* pxStats) {
+    if (uxRegion >= uxRegionCount) {
+        return pdFAIL;
+    }
+    vTaskSuspendAll();
+    *pxStats = xRegions[uxRegion].stats;
+    (void)xTaskResumeAll();
+    return pdPASS;
+}
+
+UBaseType_t uxHeapStatsRegionCount(void) {
+    return uxRegionCount;
+}
+
+uint32_t ulHeapStatsFailedAllocations(void) {
+    return ulFailedAllocations;
+}
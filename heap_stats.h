@@ -0,0 +1,52 @@
+/* heap_stats.h
+   Per-region usage and fragmentation figures for the heap_5 regions.
+   - traceMALLOC()/traceFREE() in FreeRTOSConfig.h call into this module, so every figure
+     is updated at allocation and free time and no query walks the heap_5 free list
+   - per region: free bytes, minimum ever free bytes, largest free block, allocation and
+     free counts, and fragmentation as 1 - largest / free (per mille)
+   - the largest free block comes from a bottom-up segment tree over HEAP_STATS_GRANULE
+     byte granules that keeps the longest run of free granules; an allocation or free only
+     touches the granules of that block and their ancestors. The value is therefore rounded
+     down to whole granules (under-reported by less than two granules).
+   The actual block size is read from the heap_4/heap_5 block header (BlockLink_t right in
+   front of the returned pointer), because traceMALLOC() reports the requested size, which
+   can be smaller than the block when the remainder was too small to split off.
+   The hooks run inside heap_5's scheduler-suspended section; queries suspend the scheduler
+   too, so a snapshot is always consistent.
+*/
+
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include "FreeRTOS.h"
+
+#define HEAP_STATS_MAX_REGIONS 3
+#define HEAP_STATS_GRANULE 128
+#define HEAP_STATS_MAX_GRANULES 2048 // per region, a power of two
+
+typedef struct {
+    size_t totalBytes;          // free bytes right after vPortDefineHeapRegions()
+    size_t freeBytes;
+    size_t minimumEverFreeBytes;
+    size_t largestFreeBlock;
+    uint32_t allocations;
+    uint32_t frees;
+    uint32_t fragmentationPermille;
+} HeapRegionStats;
+
+/* Call right after vPortDefineHeapRegions() with the same table. */
+void vHeapStatsInit(const HeapRegion_t* pxRegions);
+
+/* Copy the figures of one region. Fails for a region that was not defined. */
+BaseType_t xHeapStatsGetRegion(UBaseType_t uxRegion, HeapRegionStats* pxStats);
+
+UBaseType_t uxHeapStatsRegionCount(void);
+
+/* pvPortMalloc() calls that returned NULL. */
+uint32_t ulHeapStatsFailedAllocations(void);
+
+/* traceMALLOC() / traceFREE() targets. */
+void vHeapStatsOnMalloc(void* pvAddress, size_t xSize);
+void vHeapStatsOnFree(void* pvAddress, size_t xSize);
+
+#endif /* HEAP_STATS_H */
@@ -0,0 +1,125 @@
+/* job_release.c
+   Software-timer driven job releases onto a shared worker pool (see job_release.h).
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include "edf_queue.h"
+#include "job_release.h"
+#include "stack_audit.h"
+#include <stdio.h>
+
+typedef struct {
+    PeriodicJob* job;
+    TickType_t release;
+} JobReleaseMessage;
+
+static PeriodicJob* pxJobs[EDF_QUEUE_MAX_ITEMS];
+static UBaseType_t uxJobCount = 0;
+static EDFQueue xReleaseOrder; // job index keyed on its next release tick
+
+static QueueHandle_t xJobQueue = NULL;
+static StaticQueue_t xJobQueueBuffer;
+static uint8_t ucJobQueueStorage[JOB_QUEUE_LENGTH * sizeof(JobReleaseMessage)];
+
+static TimerHandle_t xReleaseTimer = NULL;
+static StaticTimer_t xReleaseTimerBuffer;
+
+static StaticTask_t xWorkerTCB[JOB_WORKER_COUNT];
+static StackType_t uxWorkerStack[JOB_WORKER_COUNT][JOB_WORKER_STACK_SIZE];
+
+static volatile uint32_t ulDropped = 0;
+
+/* Point the one-shot timer at the earliest next release. Runs in the timer task or before
+   the scheduler starts, so it must not block. */
+static void prvArmForNextRelease(TickType_t xNow) {
+    UBaseType_t uxNext;
+    if (xEDFQueuePeekMin(&xReleaseOrder, &uxNext) == pdFAIL) {
+        return;
+    }
+    TickType_t xRelease = xEDFQueueKey(&xReleaseOrder, uxNext);
+    TickType_t xDelay = (xRelease > xNow) ? xRelease - xNow : 1;
+    xTimerChangePeriod(xReleaseTimer, xDelay, 0); // also starts the timer
+}
+
+static void prvReleaseTimerCallback(TimerHandle_t xTimer) {
+    (void)xTimer;
+    UBaseType_t uxIndex;
+    TickType_t xNow = xTaskGetTickCount();
+
+    while (xEDFQueuePeekMin(&xReleaseOrder, &uxIndex) == pdPASS && xEDFQueueKey(&xReleaseOrder, uxIndex) <= xNow) {
+        PeriodicJob* job = pxJobs[uxIndex];
+        JobReleaseMessage xMsg = { job, job->nextRelease };
+
+        if (job->pending == pdTRUE) {
+            job->overruns++; // previous release not done yet; skip this one
+        }
+        else if (xQueueSend(xJobQueue, &xMsg, 0) == pdPASS) {
+            job->pending = pdTRUE;
+            job->releases++;
+        }
+        else {
+            ulDropped++;
+        }
+
+        job->nextRelease += job->period;
+        xEDFQueueUpdate(&xReleaseOrder, uxIndex, job->nextRelease);
+    }
+
+    prvArmForNextRelease(xNow);
+}
+
+static void vJobWorkerTask(void* pvParameters) {
+    (void)pvParameters;
+    JobReleaseMessage xMsg;
+    for (;;) {
+        if (xQueueReceive(xJobQueue, &xMsg, portMAX_DELAY) == pdPASS) {
+            xMsg.job->pxFunction(xMsg.job->pvContext);
+            xMsg.job->completions++;
+            xMsg.job->pending = pdFALSE;
+        }
+    }
+}
+
+void vJobReleaseInit(void) {
+    static char cNames[JOB_WORKER_COUNT][configMAX_TASK_NAME_LEN];
+
+    vEDFQueueInit(&xReleaseOrder);
+    xJobQueue = xQueueCreateStatic(JOB_QUEUE_LENGTH, sizeof(JobReleaseMessage), ucJobQueueStorage, &xJobQueueBuffer);
+    vQueueAddToRegistry(xJobQueue, "JobQueue");
+    xReleaseTimer = xTimerCreateStatic("JobRelease", 1, pdFALSE, NULL, prvReleaseTimerCallback, &xReleaseTimerBuffer);
+    configASSERT(xJobQueue != NULL && xReleaseTimer != NULL);
+
+    for (UBaseType_t i = 0; i < JOB_WORKER_COUNT; ++i) {
+        snprintf(cNames[i], sizeof(cNames[i]), "JobWorker%u", (unsigned)i);
+        TaskHandle_t xWorker = xTaskCreateStatic(vJobWorkerTask, cNames[i], JOB_WORKER_STACK_SIZE, NULL, JOB_WORKER_PRIORITY, uxWorkerStack[i], &xWorkerTCB[i]);
+        vStackAuditRegister(xWorker, JOB_WORKER_STACK_SIZE);
+    }
+}
+
+BaseType_t xJobReleaseAdd(PeriodicJob* pxJob) {
+    if (uxJobCount >= EDF_QUEUE_MAX_ITEMS) {
+        return pdFAIL;
+    }
+    configASSERT(pxJob->period > 0 && pxJob->pxFunction != NULL);
+    pxJob->index = uxJobCount;
+    pxJob->pending = pdFALSE;
+    pxJob->releases = pxJob->completions = pxJob->overruns = 0;
+    pxJobs[uxJobCount++] = pxJob;
+    return pdPASS;
+}
+
+void vJobReleaseStart(void) {
+    TickType_t xNow = xTaskGetTickCount();
+    for (UBaseType_t i = 0; i < uxJobCount; ++i) {
+        pxJobs[i]->nextRelease = xNow + pxJobs[i]->phase;
+        xEDFQueueInsert(&xReleaseOrder, i, pxJobs[i]->nextRelease);
+    }
+    prvArmForNextRelease(xNow);
+}
+
+uint32_t ulJobReleaseDropped(void) {
+    return ulDropped;
+}
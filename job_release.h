@@ -0,0 +1,56 @@
+/* job_release.h
+   Release engine for light periodic jobs that share a small pool of worker tasks.
+   - a job is a function plus a period; it has no task or stack of its own
+   - one one-shot software timer is always armed for the earliest next release, which is
+     kept in an EDFQueue keyed on release tick; the timer callback pushes every due job onto
+     the job queue and re-arms itself, so the number of jobs does not depend on
+     configTIMER_QUEUE_LENGTH and the daemon handles one timer however many jobs there are
+   - JOB_WORKER_COUNT statically allocated workers pull releases off the queue in order
+   - a job released again while its previous release is still queued or running is counted
+     as an overrun and that release is skipped rather than piling up
+   Job functions run on a worker stack (JOB_WORKER_STACK_SIZE) and must not block for long,
+   since that holds up every job behind them.
+*/
+
+#ifndef JOB_RELEASE_H
+#define JOB_RELEASE_H
+
+#include "FreeRTOS.h"
+
+#ifndef JOB_WORKER_COUNT
+#define JOB_WORKER_COUNT 3
+#endif
+#define JOB_WORKER_STACK_SIZE (configMINIMAL_STACK_SIZE + 50)
+#define JOB_WORKER_PRIORITY (tskIDLE_PRIORITY + 2)
+#define JOB_QUEUE_LENGTH 32
+
+typedef void (*JobFunction_t)(void* pvContext);
+
+typedef struct {
+    const char* name;
+    JobFunction_t pxFunction;
+    void* pvContext;
+    TickType_t period;
+    TickType_t phase;               // first release, relative to vJobReleaseStart()
+    // owned by the engine:
+    UBaseType_t index;
+    TickType_t nextRelease;
+    volatile BaseType_t pending;    // released and not completed yet
+    volatile uint32_t releases;
+    volatile uint32_t completions;
+    volatile uint32_t overruns;
+} PeriodicJob;
+
+/* Create the job queue, the release timer and the workers. Call before adding jobs. */
+void vJobReleaseInit(void);
+
+/* Register a job. Fails once EDF_QUEUE_MAX_ITEMS jobs are registered. */
+BaseType_t xJobReleaseAdd(PeriodicJob* pxJob);
+
+/* Arm the release timer. May be called before vTaskStartScheduler(). */
+void vJobReleaseStart(void);
+
+/* Releases lost because the job queue was full. */
+uint32_t ulJobReleaseDropped(void);
+
+#endif /* JOB_RELEASE_H */
@@ -0,0 +1,111 @@
+/* job_stats.c
+   Response-time and jitter histograms (see job_stats.h).
+*/
+
+#include "task.h"
+#include "job_stats.h"
+
+#define JOB_COUNTS_PER_TICK (configRUN_TIME_COUNTER_HZ / configTICK_RATE_HZ)
+
+/* Counter value at the last tick interrupt, and that tick. */
+static volatile configRUN_TIME_COUNTER_TYPE xTickStampCounter = 0;
+static volatile TickType_t xTickStampTick = 0;
+
+static UBaseType_t prvBucket(uint32_t ulValue) {
+    if (ulValue < JOB_HIST_SUB_BUCKETS) {
+        return ulValue;
+    }
+    UBaseType_t uxLog2 = 0;
+    for (uint32_t v = ulValue; v > 1; v >>= 1) {
+        uxLog2++;
+    }
+    UBaseType_t uxShift = uxLog2 - JOB_HIST_SUB_BITS;
+    return JOB_HIST_SUB_BUCKETS * (uxShift + 1) + ((ulValue >> uxShift) & (JOB_HIST_SUB_BUCKETS - 1));
+}
+
+static uint32_t prvBucketUpperBound(UBaseType_t uxBucket) {
+    if (uxBucket < JOB_HIST_SUB_BUCKETS) {
+        return (uint32_t)uxBucket;
+    }
+    UBaseType_t uxShift = uxBucket / JOB_HIST_SUB_BUCKETS - 1;
+    uint64_t ullLower = (uint64_t)(JOB_HIST_SUB_BUCKETS + uxBucket % JOB_HIST_SUB_BUCKETS) << uxShift;
+    uint64_t ullUpper = ullLower + ((uint64_t)1 << uxShift) - 1;
+    return (ullUpper > UINT32_MAX) ? UINT32_MAX : (uint32_t)ullUpper;
+}
+
+static uint32_t prvCountsToMicroseconds(configRUN_TIME_COUNTER_TYPE xCounts) {
+    uint64_t ullUs = (uint64_t)xCounts * 1000000ULL / configRUN_TIME_COUNTER_HZ;
+    return (ullUs > UINT32_MAX) ? UINT32_MAX : (uint32_t)ullUs;
+}
+
+void vJobHistogramAdd(JobHistogram* h, uint32_t ulValue) {
+    h->count[prvBucket(ulValue)]++;
+    h->samples++;
+    if (ulValue > h->max) {
+        h->max = ulValue;
+    }
+}
+
+uint32_t ulJobHistogramPercentile(const JobHistogram* h, UBaseType_t uxPercent) {
+    if (h->samples == 0) {
+        return 0;
+    }
+    if (uxPercent >= 100) {
+        return h->max;
+    }
+    // rank of the sample we are after, rounded up, at least the first one
+    uint64_t ullRank = ((uint64_t)h->samples * uxPercent + 99) / 100;
+    uint64_t ullSeen = 0;
+    for (UBaseType_t b = 0; b < JOB_HIST_BUCKETS; ++b) {
+        ullSeen += h->count[b];
+        if (ullSeen >= ullRank && ullSeen != 0) {
+            uint32_t ulBound = prvBucketUpperBound(b);
+            return (ulBound < h->max) ? ulBound : h->max;
+        }
+    }
+    return h->max;
+}
+
+void vJobStatsInit(JobStats* s, TickType_t xPeriod) {
+    *s = (JobStats){ 0 };
+    s->periodCounts = (configRUN_TIME_COUNTER_TYPE)xPeriod * JOB_COUNTS_PER_TICK;
+}
+
+void vJobStatsTickHook(void) {
+    xTickStampCounter = portGET_RUN_TIME_COUNTER_VALUE();
+    xTickStampTick = xTaskGetTickCountFromISR();
+}
+
+void vJobStatsStart(JobStats* s, TickType_t xReleaseTick) {
+    configRUN_TIME_COUNTER_TYPE xNow, xStamp;
+    TickType_t xTick, xStampTick;
+
+    taskENTER_CRITICAL(); // the stamp and the tick it belongs to are read as a pair
+    xNow = portGET_RUN_TIME_COUNTER_VALUE();
+    xTick = xTaskGetTickCount();
+    xStamp = xTickStampCounter;
+    xStampTick = xTickStampTick;
+    taskEXIT_CRITICAL();
+
+    s->releaseTick = xReleaseTick;
+    s->startLag = xTick - xReleaseTick;
+    s->start = xNow;
+
+    // start - release: whole ticks up to the last stamped tick boundary, then the counter
+    // from there. Should the last stamp be older than the release (a tick whose hook has not
+    // run yet), only the whole ticks are known.
+    configRUN_TIME_COUNTER_TYPE xLag = (configRUN_TIME_COUNTER_TYPE)s->startLag * JOB_COUNTS_PER_TICK;
+    if ((TickType_t)(xStampTick - xReleaseTick) <= s->startLag && xNow >= xStamp) {
+        xLag = (configRUN_TIME_COUNTER_TYPE)(TickType_t)(xStampTick - xReleaseTick) * JOB_COUNTS_PER_TICK + (xNow - xStamp);
+    }
+    vJobHistogramAdd(&s->jitter, prvCountsToMicroseconds(xLag));
+}
+
+void vJobStatsComplete(JobStats* s) {
+    s->completion = portGET_RUN_TIME_COUNTER_VALUE();
+
+    // the release is only known to the tick, the execution to the counter
+    configRUN_TIME_COUNTER_TYPE xResponse = (configRUN_TIME_COUNTER_TYPE)s->startLag * JOB_COUNTS_PER_TICK + (s->completion - s->start);
+    vJobHistogramAdd(&s->response, prvCountsToMicroseconds(xResponse));
+    s->jobs++;
+}
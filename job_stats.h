@@ -0,0 +1,56 @@
+/* job_stats.h
+   Per-job timing instrumentation for the periodic demo tasks.
+   - each job records its nominal release (tick), its start and its completion
+     (run-time counter, see Run-time-stats-utils.c, configRUN_TIME_COUNTER_HZ)
+   - response time = completion - nominal release: the whole ticks between the release and
+     the start, plus the counter time from start to completion
+   - release jitter = start - nominal release: the whole ticks up to the last tick interrupt
+     plus the counter time since it, which vJobStatsTickHook() stamps on every tick
+   - both go into fixed log-scale histograms held in the task's own JobStats (no allocation):
+     4 sub-buckets per power of two, so a percentile is reported within 25% of the true value
+   - JobStats is written only by the task that owns it; readers may see a job half-recorded
+*/
+
+#ifndef JOB_STATS_H
+#define JOB_STATS_H
+
+#include "FreeRTOS.h"
+
+#define JOB_HIST_SUB_BITS 2
+#define JOB_HIST_SUB_BUCKETS (1u << JOB_HIST_SUB_BITS)
+#define JOB_HIST_BUCKETS (JOB_HIST_SUB_BUCKETS * (32 - JOB_HIST_SUB_BITS + 1)) // covers every uint32_t
+
+typedef struct {
+    uint32_t count[JOB_HIST_BUCKETS];
+    uint32_t samples;
+    uint32_t max;
+} JobHistogram;
+
+typedef struct {
+    TickType_t releaseTick;                   // nominal release of the current/last job
+    TickType_t startLag;                      // whole ticks between that release and the start
+    configRUN_TIME_COUNTER_TYPE start;        // counter when the job started
+    configRUN_TIME_COUNTER_TYPE completion;   // counter when the job completed
+    configRUN_TIME_COUNTER_TYPE periodCounts; // period in counter units
+    uint32_t jobs;
+    JobHistogram response;                    // microseconds
+    JobHistogram jitter;                      // microseconds
+} JobStats;
+
+void vJobStatsInit(JobStats* s, TickType_t xPeriod);
+
+/* Call from vApplicationTickHook(): stamps the counter at each tick boundary. */
+void vJobStatsTickHook(void);
+
+/* Call when a job starts running, with the tick it was nominally released at. */
+void vJobStatsStart(JobStats* s, TickType_t xReleaseTick);
+
+/* Call when the job started by the last vJobStatsStart() completes. */
+void vJobStatsComplete(JobStats* s);
+
+void vJobHistogramAdd(JobHistogram* h, uint32_t ulValue);
+
+/* Upper bound of the bucket holding the uxPercent-th percentile sample (max for 100). */
+uint32_t ulJobHistogramPercentile(const JobHistogram* h, UBaseType_t uxPercent);
+
+#endif /* JOB_STATS_H */
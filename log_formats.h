@@ -0,0 +1,48 @@
+/* log_formats.h
+   Interned format strings for the deferred logger (deferred_log.h).
+   Every log call site in the demos has an entry here; the first column becomes a LogFormatId
+   and the hot path records only that 16-bit id plus the raw argument words. Add new formats
+   at the end of the table.
+*/
+
+#ifndef LOG_FORMATS_H
+#define LOG_FORMATS_H
+
+#define LOG_FORMAT_TABLE(X) \
+    X(LOG_EDF_EXECUTING,            "%s: executing") \
+    X(LOG_FT_PRIMARY_STARTED,       "[%s] Primary started") \
+    X(LOG_FT_PRIMARY_OVERRUN,       "[%s] Primary: OVERRUN") \
+    X(LOG_FT_PRIMARY_SUCCESS,       "[%s] Primary: SUCCESS") \
+    X(LOG_FT_PRIMARY_MISSED,        "[%s] ⚠️ PRIMARY missed deadline (primarySuccess=false) at %lu") \
+    X(LOG_FT_PRIMARY_LATE,          "[%s] ⚠️ PRIMARY finished after deadline (late success) at %lu") \
+    X(LOG_FT_BACKUP_ACTIVATED,      "[%s] BACKUP activated (primary failed)") \
+    X(LOG_FT_SUMMARY_HEADER,        "---- Fault Tolerant EDF Summary ----") \
+    X(LOG_FT_SUMMARY_TASK,          "  [%s] successes=%lu backups=%lu deadline_misses=%lu dropped=%lu budget_stops=%lu") \
+    X(LOG_WD_HEARTBEAT,             "Worker (bit %lu) heartbeat sent") \
+    X(LOG_WD_RESTART,               "Supervisor: Restarting %s (missed %lu cycles)") \
+    X(LOG_JOB_RESPONSE,             "  [%s] response_us p50=%lu p99=%lu max=%lu") \
+    X(LOG_JOB_JITTER,               "  [%s] jitter_us   p50=%lu p99=%lu max=%lu") \
+    X(LOG_EDF_SUMMARY_HEADER,       "---- EDF Summary ----") \
+    X(LOG_EDF_SUMMARY_TASK,         "  [%s] jobs=%lu") \
+    X(LOG_JOB_RUNNING,              "%s is running") \
+    X(LOG_JOBREL_SUMMARY_HEADER,    "---- Job Release Summary (%lu jobs on %lu workers) ----") \
+    X(LOG_JOBREL_SUMMARY_JOB,       "  [%s] releases=%lu completions=%lu overruns=%lu") \
+    X(LOG_JOBREL_SUMMARY_LIGHT,     "  [light x%lu] releases=%lu overruns=%lu dropped=%lu") \
+    X(LOG_HEAP_REGION,              "  heap[%lu] free=%lu min=%lu largest=%lu frag=%lu/1000 allocs=%lu") \
+    X(LOG_HEAP_FAILED,              "  heap failed_allocs=%lu") \
+    X(LOG_POOL_CLASS,               "  pool[%lu] bytes=%lu blocks=%lu free=%lu min=%lu") \
+    X(LOG_POOL_FALLBACKS,           "  pool heap_fallbacks=%lu") \
+    X(LOG_STACK_AUDIT_HEADER,       "---- Stack Audit (words, %lu samples skipped) ----") \
+    X(LOG_STACK_AUDIT_TASK,         "  %-12s depth=%lu used=%lu worst_free=%lu recommended=%lu") \
+    X(LOG_STACK_AUDIT_UNSIZED,      "  %-12s depth=? worst_free=%lu") \
+    X(LOG_STACK_AUDIT_FOOTER,       "  reclaimable=%lu words (%lu bytes)") \
+    X(LOG_FT_MODE_HI,               "[%s] exceeded its LO budget: HI mode at %lu") \
+    X(LOG_FT_MODE_LO,               "Idle instant: LO mode at %lu") \
+    X(LOG_FT_SUMMARY_MODE,          "  mode=%s switches=%lu") \
+    X(LOG_FT_BUDGET_STOPPED,        "[%s] Primary: stopped on its budget at %lu, backup released") \
+    X(LOG_EDF_SERVER_KEY,           "EDF_Server: key %lu") \
+    X(LOG_EDF_SERVER_SUMMARY,       "  [%s] requests=%lu dropped=%lu replenishments=%lu") \
+    X(LOG_KEYS_DROPPED,             "%lu key presses dropped, the key ring was full") \
+    X(LOG_SERVICE_FAULTS,           "  faults overrun=%lu backup=%lu deadline_miss=%lu heartbeat=%lu restart=%lu dropped=%lu")
+
+#endif /* LOG_FORMATS_H */
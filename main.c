@@ -69,6 +69,17 @@
 /* FreeRTOS+Trace includes. */
 #include "trcRecorder.h"
 
+/* Deferred logger used by the blinky demos. */
+#include "deferred_log.h"
+#include "block_pool.h"
+#include "heap_stats.h"
+#include "stack_audit.h"
+#include "service_loop.h"
+#include "metrics_export.h"
+#include "trace_stream.h"
+#include "trace_map.h"
+#include "job_stats.h"
+
 /* This project provides two demo applications.  A simple blinky style demo
  * application, and a more comprehensive test and demo application.  The
  * mainCREATE_SIMPLE_BLINKY_DEMO_ONLY setting is used to select between the two.
@@ -92,13 +103,31 @@
 #define mainREGION_3_SIZE                     168070
 
   /* This demo allows for users to perform actions with the keyboard. */
-#define mainNO_KEY_PRESS_VALUE                -1
 #define mainOUTPUT_TRACE_KEY                  't'
 #define mainINTERRUPT_NUMBER_KEYBOARD         3
 
+/* How long one idle hook call sleeps the idle thread on the host, see
+ * vApplicationIdleHook(). */
+#define mainIDLE_SLEEP_MS                     15
+
+/* Key presses waiting for the key handler task; must be a power of two. */
+#define mainKEY_RING_LENGTH                   64
+#define mainKEY_HANDLER_PRIORITY              ( tskIDLE_PRIORITY + 1 )
+
 /* This demo allows to save a trace file. */
 #define mainTRACE_FILE_NAME                   "Trace.dump"
 
+/* Set to 1 to drain the recorder continuously into mainTRACE_STREAM_FILE_NAME from a
+ * background Windows thread (trace_stream.c).  The trace key and configASSERT() then
+ * only signal that thread instead of writing the file inside a critical section. */
+#define mainTRACE_STREAMING                   1
+#define mainTRACE_STREAM_FILE_NAME            "Trace.stream"
+
+/* Set to 1 to have the recorder write straight into mainTRACE_FILE_NAME mapped into
+ * memory (trace_map.c), so a snapshot is only a page flush and the file survives a
+ * crash.  Needs the recorder built with TRC_RECORDER_BUFFER_ALLOCATION_CUSTOM. */
+#define mainTRACE_MAPPED_FILE                 0
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -145,22 +174,42 @@ void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer,
  */
 static void prvSaveTraceFile(void);
 
+/*
+ * Gets the trace onto disk by whichever route is configured: a page flush of the
+ * mapped trace file, a snapshot by the stream thread, or prvSaveTraceFile() in a
+ * critical section.  xStopped is pdTRUE when called from vAssertCalled(), where
+ * the FreeRTOS threads are already held and the recorder is disabled.
+ */
+static void prvSnapshotTrace(BaseType_t xStopped);
+
 /*
  * Windows thread function to capture keyboard input from outside of the
  * FreeRTOS simulator. This thread passes data safely into the FreeRTOS
- * simulator using a stream buffer.
+ * simulator through a single-producer single-consumer ring.
  */
 static int32_t WINAPI prvWindowsKeyboardInputThread(void* pvParam);
 
 /*
- * Interrupt handler for when keyboard input is received.
+ * Interrupt handler for when keyboard input is received.  It only wakes the
+ * key handler task.
  */
 static uint32_t prvKeyboardInterruptHandler(void);
 
 /*
- * Keyboard interrupt handler for the blinky demo.
+ * Task that drains the key ring, a batch per wake, and acts on each key.
+ */
+static void prvKeyHandlerTask(void* pvParameters);
+
+/*
+ * Key handler for the blinky demo, called from the key handler task.
+ */
+extern void vBlinkyKeyHandler(int xKeyPressed);
+
+/*
+ * Budget enforcement for the fault-tolerant demo, run from the tick hook.  Returns
+ * pdTRUE if it woke a task.
  */
-extern void vBlinkyKeyboardInterruptHandler(int xKeyPressed);
+extern void vBlinkyTickHookFunction(void);
 
 /*-----------------------------------------------------------*/
 
@@ -175,11 +224,21 @@ StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
 /* Thread handle for the keyboard input Windows thread. */
 static HANDLE xWindowsKeyboardInputThreadHandle = NULL;
 
-/* This stores the last key pressed that has not been handled.
- * Keyboard input is retrieved by the prvWindowsKeyboardInputThread
- * Windows thread and stored here. This is then read by the idle
- * task and handled appropriately. */
-static int xKeyPressed = mainNO_KEY_PRESS_VALUE;
+/* Key presses from the prvWindowsKeyboardInputThread Windows thread to the
+ * key handler task.  The Windows thread is the only writer of ulKeyRingHead and
+ * the task the only writer of ulKeyRingTail, so no lock is needed. */
+static int xKeyRing[mainKEY_RING_LENGTH];
+static volatile uint32_t ulKeyRingHead = 0;
+static volatile uint32_t ulKeyRingTail = 0;
+static volatile uint32_t ulKeysDropped = 0;
+
+static TaskHandle_t xKeyHandlerTask = NULL;
+
+
+#if ( mainTRACE_MAPPED_FILE == 1 )
+    /* pdTRUE when the recorder data lives in the mapped trace file. */
+    static BaseType_t xTraceMapped = pdFALSE;
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -193,6 +252,18 @@ int main(void)
     /* Initialise the trace recorder.  Use of the trace recorder is optional.
      * See http://www.FreeRTOS.org/trace for more information. */
 
+#if ( mainTRACE_MAPPED_FILE == 1 )
+    {
+        static RecorderDataType xUnmappedRecorderData;
+        void* pvView = pvTraceMapOpen(mainTRACE_FILE_NAME, sizeof(RecorderDataType));
+
+        /* Fall back to an ordinary buffer, saved the usual way, if the file cannot be
+         * mapped. */
+        xTraceMapped = (pvView != NULL) ? pdTRUE : pdFALSE;
+        vTraceSetRecorderDataBuffer((pvView != NULL) ? pvView : &xUnmappedRecorderData);
+    }
+#endif
+
     configASSERT(xTraceInitialize() == TRC_SUCCESS);
 
     /* Start the trace recording - the recording is written to a file if
@@ -207,6 +278,24 @@ int main(void)
 
     configASSERT(xTraceEnable(TRC_START) == TRC_SUCCESS);
 
+#if ( mainTRACE_STREAMING == 1 )
+#if ( mainTRACE_MAPPED_FILE == 1 )
+    /* The mapped file already is the snapshot; the stream thread must not rewrite it. */
+    if (xTraceStreamStart(mainTRACE_STREAM_FILE_NAME, (xTraceMapped != pdFALSE) ? NULL : mainTRACE_FILE_NAME) != 0)
+#else
+    if (xTraceStreamStart(mainTRACE_STREAM_FILE_NAME, mainTRACE_FILE_NAME) != 0)
+#endif
+    {
+        printf("Trace events are also streamed to \"%s\".\r\n", mainTRACE_STREAM_FILE_NAME);
+    }
+#endif
+
+    /* The bottom half of the keyboard interrupt. */
+    xTaskCreate(prvKeyHandlerTask, "KeyHandler", configMINIMAL_STACK_SIZE + 40, NULL,
+        mainKEY_HANDLER_PRIORITY, &xKeyHandlerTask);
+    configASSERT(xKeyHandlerTask != NULL);
+    vStackAuditRegister(xKeyHandlerTask, configMINIMAL_STACK_SIZE + 40);
+
     /* Set interrupt handler for keyboard input. */
     vPortSetInterruptHandler(mainINTERRUPT_NUMBER_KEYBOARD, prvKeyboardInterruptHandler);
 
@@ -229,7 +318,14 @@ int main(void)
         //To run EDF + Scheduler - main_blinky();
         //To run Fault - Tolerant EDF - main_fault_tolerant_demo();
         //To run Watchdog Supervisor - main_watchdog_demo();
+        //To run Job Release engine - main_job_release_demo();
+        //To run the replay benchmark - main_benchmark();
         printf("\nStarting the demo.\r\n");
+        vServiceLoopInit();
+        vStackAuditStart();
+        if (xMetricsExportStart() == pdPASS) {
+            printf("Metrics are served on http://127.0.0.1:%d/metrics\r\n", METRICS_EXPORT_PORT);
+        }
         main_watchdog_demo();
     }
 #else
@@ -279,6 +375,15 @@ void vApplicationIdleHook(void)
          * blinky demo does not use the idle task hook. */
         vFullDemoIdleFunction();
     }
+#else
+    {
+        /* Idle-thread host sleep, not tickless idle: nothing is ready, so give the
+         * host core back instead of spinning on it.  This is a Windows wait, not a
+         * FreeRTOS block - the tick keeps running, and a task it (or a simulated
+         * interrupt) readies preempts the idle thread as usual.  The sleep is kept
+         * short so the idle task still gets round to its own housekeeping. */
+        Sleep(mainIDLE_SLEEP_MS);
+    }
 #endif
 }
 
@@ -311,6 +416,11 @@ void vApplicationTickHook(void)
     {
         vFullDemoTickHookFunction();
     }
+#else
+    {
+        vJobStatsTickHook();
+        vBlinkyTickHookFunction();
+    }
 #endif /* mainCREATE_SIMPLE_BLINKY_DEMO_ONLY */
 }
 /*-----------------------------------------------------------*/
@@ -339,11 +449,15 @@ void vAssertCalled(unsigned long ulLine,
 
     taskENTER_CRITICAL();
     {
+#if ( mainCREATE_SIMPLE_BLINKY_DEMO_ONLY == 1 )
+        /* Print whatever the demo tasks logged up to this point first. */
+        vLogFlush();
+#endif
         printf("ASSERT! Line %ld, file %s, GetLastError() %ld\r\n", ulLine, pcFileName, GetLastError());
 
         /* Stop the trace recording and save the trace. */
         (void)xTraceDisable();
-        prvSaveTraceFile();
+        prvSnapshotTrace(pdTRUE);
 
         /* Cause debugger break point if being debugged. */
         __debugbreak();
@@ -363,6 +477,58 @@ void vAssertCalled(unsigned long ulLine,
 }
 /*-----------------------------------------------------------*/
 
+static void prvSnapshotTrace(BaseType_t xStopped)
+{
+#if ( mainTRACE_MAPPED_FILE == 1 )
+    if (xTraceMapped != pdFALSE)
+    {
+        /* The recorder data already is the file, only the dirty pages are written. */
+        if (xTraceMapFlush() != 0)
+        {
+            printf("\r\nTrace output flushed to %s\r\n\r\n", mainTRACE_FILE_NAME);
+        }
+        return;
+    }
+#endif
+
+#if ( mainTRACE_STREAMING == 1 )
+    if (xStopped != pdFALSE)
+    {
+        /* The stream thread keeps running while the FreeRTOS threads are held. */
+        if (xTraceStreamSnapshotAndWait() != 0)
+        {
+            return;
+        }
+    }
+    else
+    {
+        /* The stream thread copies the recorder buffer and writes it out; the
+         * scheduler keeps running. */
+        vTraceStreamRequestSnapshot();
+        return;
+    }
+#endif
+
+    if (xStopped != pdFALSE)
+    {
+        prvSaveTraceFile();
+    }
+    else
+    {
+        /* Saving the trace file requires Windows system calls, so enter a critical
+         * section to prevent deadlock or errors resulting from calling a Windows
+         * system call from within the FreeRTOS simulator. */
+        portENTER_CRITICAL();
+        {
+            (void)xTraceDisable();
+            prvSaveTraceFile();
+            (void)xTraceEnable(TRC_START);
+        }
+        portEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
+
 static void prvSaveTraceFile(void)
 {
     FILE* pxOutputFile;
@@ -394,7 +560,7 @@ static void prvInitialiseHeap(void)
      * order, so this just creates one big array, then populates the structure with
      * offsets into the array - with gaps in between and messy alignment just for test
      * purposes. */
-    static uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+    static uint8_t ucHeap[configTOTAL_HEAP_SIZE + BLOCK_POOL_TOTAL_BYTES];
     volatile uint32_t ulAdditionalOffset = 19; /* Just to prevent 'condition is always true' warnings in configASSERT(). */
     const HeapRegion_t xHeapRegions[] =
     {
@@ -413,6 +579,13 @@ static void prvInitialiseHeap(void)
     (void)ulAdditionalOffset;
 
     vPortDefineHeapRegions(xHeapRegions);
+    vHeapStatsInit(xHeapRegions);
+
+    /* The array continues past region 3 with the fixed-size block pools
+     * (block_pool.h), which heap_5 never sees. They are sized for the largest task
+     * sets, so they get their own space rather than a cut of region 3. */
+    vBlockPoolInit(ucHeap + 19 + mainREGION_1_SIZE + mainREGION_2_SIZE + mainREGION_3_SIZE,
+                   BLOCK_POOL_TOTAL_BYTES);
 }
 /*-----------------------------------------------------------*/
 
@@ -474,44 +647,69 @@ void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer,
  */
 static uint32_t prvKeyboardInterruptHandler(void)
 {
-    /* Handle keyboard input. */
-    switch (xKeyPressed)
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    /* The keys stay in the ring; one notification covers however many arrived
+     * before the handler task runs. */
+    xTaskNotifyFromISR(xKeyHandlerTask, 0, eIncrement, &xHigherPriorityTaskWoken);
+
+    return (uint32_t)xHigherPriorityTaskWoken;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvKeyHandlerTask(void* pvParameters)
+{
+    uint32_t ulLastDropped = 0;
+
+    (void)pvParameters;
+
+    for (; ; )
     {
-    case mainNO_KEY_PRESS_VALUE:
-        break;
+        BaseType_t xSnapshot = pdFALSE;
 
-    case mainOUTPUT_TRACE_KEY:
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        /* Saving the trace file requires Windows system calls, so enter a critical
-         * section to prevent deadlock or errors resulting from calling a Windows
-         * system call from within the FreeRTOS simulator. */
-        portENTER_CRITICAL();
+        while (ulKeyRingTail != ulKeyRingHead)
         {
-            (void)xTraceDisable();
-            prvSaveTraceFile();
-            (void)xTraceEnable(TRC_START);
-        }
-        portEXIT_CRITICAL();
-        break;
-
-    default:
+            int xKey = xKeyRing[ulKeyRingTail & (mainKEY_RING_LENGTH - 1)];
+
+            /* Hand the slot back only once it has been read. */
+            MemoryBarrier();
+            ulKeyRingTail++;
+
+            if (xKey == mainOUTPUT_TRACE_KEY)
+            {
+                /* A burst of trace keys still takes a single snapshot. */
+                xSnapshot = pdTRUE;
+            }
+            else
+            {
 #if ( mainCREATE_SIMPLE_BLINKY_DEMO_ONLY == 1 )
-        /* Call the keyboard interrupt handler for the blinky demo. */
-       // vBlinkyKeyboardInterruptHandler( xKeyPressed );
+                vBlinkyKeyHandler(xKey);
 #endif
-        break;
-    }
+            }
+        }
+
+        if (xSnapshot != pdFALSE)
+        {
+            prvSnapshotTrace(pdFALSE);
+        }
 
-    /* This interrupt does not require a context switch so return pdFALSE */
-    return pdFALSE;
+        if (ulKeysDropped != ulLastDropped)
+        {
+            ulLastDropped = ulKeysDropped;
+            xLogEvent(LOG_KEYS_DROPPED, (unsigned long)ulLastDropped);
+        }
+    }
 }
 
 /*-----------------------------------------------------------*/
 
 /*
  * Windows thread function to capture keyboard input from outside of the
- * FreeRTOS simulator. This thread passes data into the simulator using
- * an integer.
+ * FreeRTOS simulator. This thread passes data into the simulator through
+ * the key ring.
  */
 static int32_t WINAPI prvWindowsKeyboardInputThread(void* pvParam)
 {
@@ -520,7 +718,20 @@ static int32_t WINAPI prvWindowsKeyboardInputThread(void* pvParam)
     for (; ; )
     {
         /* Block on acquiring a key press. */
-        xKeyPressed = _getch();
+        int xKey = _getch();
+
+        if ((uint32_t)(ulKeyRingHead - ulKeyRingTail) < mainKEY_RING_LENGTH)
+        {
+            xKeyRing[ulKeyRingHead & (mainKEY_RING_LENGTH - 1)] = xKey;
+
+            /* Publish the slot only once it has been written. */
+            MemoryBarrier();
+            ulKeyRingHead++;
+        }
+        else
+        {
+            ulKeysDropped++;
+        }
 
         /* Notify FreeRTOS simulator that there is a keyboard interrupt.
          * This will trigger prvKeyboardInterruptHandler.
@@ -534,20 +745,32 @@ static int32_t WINAPI prvWindowsKeyboardInputThread(void* pvParam)
 
 /*-----------------------------------------------------------*/
 
-/* The below code is used by the trace recorder for timing. */
-static uint32_t ulEntryTime = 0;
+/* The below code is used by the trace recorder for timing.  The Windows
+ * performance counter is used rather than the tick count, so trace timestamps
+ * have sub-tick resolution.  The recorder works with differences between
+ * readings, so the 32-bit value wrapping is harmless. */
+static LONGLONG llEntryTime = 0;
 
 void vTraceTimerReset(void)
 {
-    ulEntryTime = xTaskGetTickCount();
+    LARGE_INTEGER liNow;
+
+    QueryPerformanceCounter(&liNow);
+    llEntryTime = liNow.QuadPart;
 }
 
 uint32_t uiTraceTimerGetFrequency(void)
 {
-    return configTICK_RATE_HZ;
+    LARGE_INTEGER liFrequency;
+
+    QueryPerformanceFrequency(&liFrequency);
+    return (uint32_t)liFrequency.QuadPart;
 }
 
 uint32_t uiTraceTimerGetValue(void)
 {
-    return(xTaskGetTickCount() - ulEntryTime);
-}
+    LARGE_INTEGER liNow;
+
+    QueryPerformanceCounter(&liNow);
+    return (uint32_t)(liNow.QuadPart - llEntryTime);
+}
\ No newline at end of file
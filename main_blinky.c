@@ -1,82 +1,446 @@
 /* main_blinky.c
    Combined demos:
-   - Basic EDF (kept minimal)
-   - Fault-Tolerant EDF (primary + backup, random overruns, logging)
-   - Watchdog Supervisor (2 workers, supervisor expects bitwise notifications every 100ms)
+   - Basic EDF (event-driven, N tasks, a constant-bandwidth server for key presses)
+   - Fault-Tolerant EDF (primary + backup, random overruns, logging, LO/HI criticality modes)
+   - Watchdog Supervisor (table of up to 32 workers, one heartbeat bit each, restarts reuse
+     static task memory)
+   - Job Release (many light periodic jobs released by one software timer onto a shared
+     worker pool)
+   - Replay benchmark (a seeded task-set description run through the EDF or FT policy, or
+     one partition of a partitioned-EDF packing, metrics printed as JSON lines)
 */
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "edf_queue.h"
+#include "edf_bands.h"
+#include "deferred_log.h"
+#include "job_stats.h"
+#include "edf_admission.h"
+#include "edf_partition.h"
+#include "job_release.h"
+#include "block_pool.h"
+#include "heap_stats.h"
+#include "stack_audit.h"
+#include "bench.h"
+#include "prng.h"
+#include "cbs_server.h"
+#include "event_channel.h"
+#include "service_loop.h"
+#include "seq_stats.h"
+#include "metrics_export.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <limits.h>
 
-#define NUM_FT_TASKS 2
+#if defined(_MSC_VER)
+#include <intrin.h> /* _BitScanForward */
+#endif
+
+#define NUM_FT_TASKS 2 // jobs of the demo set
+#define FT_MAX_TASKS 8 // any set given to prvFT_Setup()
+#define FT_FAULT_SEED 0 // seed of the primaries' fault injection; 0 takes one from time(NULL)
+#define FT_BUDGET_SLACK_US 2000 // budgets are checked once a tick and a job may start a tick after its clock does
 
 /* ----------------------------
    ---------- Utilities --------
    ---------------------------- */
-static void vPrintTimestamped(const char* fmt, ...)
+static void prvReportJobStats(const char* name, const JobStats* s)
+{
+    xLogEvent(LOG_JOB_RESPONSE, name,
+        (unsigned long)ulJobHistogramPercentile(&s->response, 50),
+        (unsigned long)ulJobHistogramPercentile(&s->response, 99),
+        (unsigned long)s->response.max);
+    xLogEvent(LOG_JOB_JITTER, name,
+        (unsigned long)ulJobHistogramPercentile(&s->jitter, 50),
+        (unsigned long)ulJobHistogramPercentile(&s->jitter, 99),
+        (unsigned long)s->jitter.max);
+}
+
+/* xTaskCreate() that also tells the stack audit the depth it was given. */
+static TaskHandle_t prvCreateAuditedTask(TaskFunction_t pxCode, const char* pcName, configSTACK_DEPTH_TYPE usDepth,
+    void* pvParameters, UBaseType_t uxPriority)
+{
+    TaskHandle_t xTask = NULL;
+    if (xTaskCreate(pxCode, pcName, usDepth, pvParameters, uxPriority, &xTask) == pdPASS) {
+        vStackAuditRegister(xTask, usDepth);
+    }
+    return xTask;
+}
+
+static void prvReportHeapStats(void)
 {
-    va_list ap;
-    va_start(ap, fmt);
-    TickType_t t = xTaskGetTickCount();
-    printf("[%lu ms] ", (unsigned long)t);
-    vprintf(fmt, ap);
-    printf("\n");
-    va_end(ap);
+    HeapRegionStats xStats;
+    for (UBaseType_t r = 0; xHeapStatsGetRegion(r, &xStats) == pdPASS; ++r) {
+        xLogEvent(LOG_HEAP_REGION, (unsigned long)r,
+            (unsigned long)xStats.freeBytes,
+            (unsigned long)xStats.minimumEverFreeBytes,
+            (unsigned long)xStats.largestFreeBlock,
+            (unsigned long)xStats.fragmentationPermille,
+            (unsigned long)xStats.allocations);
+    }
+    xLogEvent(LOG_HEAP_FAILED, (unsigned long)ulHeapStatsFailedAllocations());
+}
+
+static void prvReportBlockPools(void)
+{
+    static const size_t xClassBytes[BLOCK_POOL_CLASS_COUNT] = {
+#define BLOCK_POOL_BYTES(id, bytes, blocks) BLOCK_POOL_ROUND(bytes),
+        BLOCK_POOL_CLASSES(BLOCK_POOL_BYTES)
+#undef BLOCK_POOL_BYTES
+    };
+    for (UBaseType_t c = 0; c < BLOCK_POOL_CLASS_COUNT; ++c) {
+        xLogEvent(LOG_POOL_CLASS, (unsigned long)c,
+            (unsigned long)xClassBytes[c],
+            (unsigned long)uxBlockPoolBlocks((BlockPoolClass)c),
+            (unsigned long)uxBlockPoolFreeBlocks((BlockPoolClass)c),
+            (unsigned long)uxBlockPoolMinimumEverFreeBlocks((BlockPoolClass)c));
+    }
+    xLogEvent(LOG_POOL_FALLBACKS, (unsigned long)ulBlockPoolHeapFallbacks());
 }
 
 /* ----------------------------
    ----- Basic EDF (kept) -----
    ---------------------------- */
+
+   /* Event-driven EDF:
+      - a task reports its absolute deadline when a job is released and again when it
+        completes (the completion deadline is that of the next job)
+      - only reports that actually move the deadline reach the scheduler: the task sets
+        its bit in ulEDFPending[] and notifies the scheduler with the bit of that word
+      - the scheduler sleeps on xTaskNotifyWait and re-keys just the reported tasks in an
+        indexed deadline heap (edf_queue.c), so picking the earliest deadline is O(log N)
+      - deadline ranks are compressed into the priority bands left below the scheduler and
+        the timer daemon (edf_bands.c); vTaskPrioritySet is only called when a band changes
+
+      Aperiodic work:
+      - a constant-bandwidth server (cbs_server.c) takes the slot after the periodic tasks in
+        edfTasks[] and reports its server deadline through the same path, so the scheduler
+        ranks it like any other EDF task
+      - requests are queued to it (key presses, from main.c's key handler task) and charged to its
+        budget; a request is not cut short, so the budget is enforced between requests
+      - the admission test counts it as a periodic task with C = budget and T = D = period
+   */
+
+#define NUM_EDF_TASKS 4   // tasks of the demo set
+#define EDF_MAX_TASKS 200 // any set given to prvEDF_Setup(), server included
+#define EDF_PENDING_WORDS ((EDF_MAX_TASKS + 31) / 32)
+
+#if (EDF_PENDING_WORDS > 32)
+#error "The EDF pending mask only covers 32 words of 32 tasks"
+#endif
+#if (EDF_MAX_TASKS > EDF_QUEUE_MAX_ITEMS)
+#error "EDF_MAX_TASKS exceeds EDF_QUEUE_MAX_ITEMS"
+#endif
+#if (EDF_MAX_TASKS > BLOCK_POOL_TASK_SMALL_BLOCKS || 2 * FT_MAX_TASKS > BLOCK_POOL_TASK_LARGE_BLOCKS)
+#error "The block pool's task classes do not cover EDF_MAX_TASKS and 2 * FT_MAX_TASKS"
+#endif
+
 typedef struct {
     TaskHandle_t handle;
     TickType_t period;
-    TickType_t next_deadline;
+    TickType_t deadline;      // relative
+    TickType_t next_deadline; // written by the task, copied into xEDFReady by the scheduler
+    UBaseType_t index;        // position in edfTasks[] and item id in xEDFReady
     const char* name;
+    JobStats stats;
+    uint32_t deadlineMisses;
+    BenchJobModel* model;     // job source in the benchmark, NULL in the demo
 } EDFTask;
 
-static EDFTask edfTasks[2];
+typedef struct {
+    const char* name;
+    uint32_t periodMs;
+    uint32_t deadlineMs; // relative
+    uint32_t wcetMs;     // declared budget, used by the admission test
+} EDFTaskDef;
 
-static void vEDF_TaskA(void* pvParameters) {
-    EDFTask* task = (EDFTask*)pvParameters;
-    TickType_t xLastWake = xTaskGetTickCount();
-    for (;;) {
-        vPrintTimestamped("%s: executing", task->name);
-        task->next_deadline = xTaskGetTickCount() + task->period;
-        vTaskDelayUntil(&xLastWake, task->period);
+static const EDFTaskDef edfTaskSet[NUM_EDF_TASKS] = {
+    { "EDF_TaskA", 300, 300, 10 },
+    { "EDF_TaskB", 500, 500, 20 },
+    { "EDF_TaskC", 700, 700, 30 },
+    { "EDF_TaskD", 1100, 1100, 40 },
+};
+
+typedef struct {
+    const char* name;
+    uint32_t budgetUs;
+    uint32_t periodMs;
+} EDFServerDef;
+
+#define EDF_SERVER_QUEUE_LENGTH 16
+#define EDF_SERVER_KEY_WORK_US 5000 // simulated handling of one key press
+
+static const EDFServerDef edfServerDef = { "EDF_Server", 20000, 200 }; // 10% of the CPU
+
+typedef struct {
+    void (*pxFunction)(void* pvParameter);
+    void* pvParameter;
+    configRUN_TIME_COUNTER_TYPE arrival; // counter at submission, for the response time
+} EDFServerRequest;
+
+static EDFTask edfTasks[EDF_MAX_TASKS];
+static UBaseType_t uxEDFTaskCount = 0;
+static EDFQueue xEDFReady; // all EDF tasks keyed on the deadline the scheduler last saw
+static EDFBandMap xEDFBands;
+static volatile uint32_t ulEDFPending[EDF_PENDING_WORDS];
+static TaskHandle_t xEDFScheduler = NULL;
+static BenchSchedulerCost xEDFSchedulerCost; // what each scheduler pass costs, for the benchmark
+
+static CBSServer xEDFServer;
+static EDFTask* pxEDFServerTask = NULL; // its slot in edfTasks[], NULL when the set has no server
+static QueueHandle_t xEDFServerQueue = NULL;
+static JobHistogram xEDFServerResponse; // arrival to completion, microseconds
+static uint32_t ulEDFServerRequests = 0;
+static uint32_t ulEDFServerDropped = 0;
+
+static uint32_t prvCounterToUs(configRUN_TIME_COUNTER_TYPE ullCounts) {
+    return (uint32_t)(ullCounts * 1000000ULL / configRUN_TIME_COUNTER_HZ);
+}
+
+static UBaseType_t prvLowestSetBit(uint32_t ulBits) {
+#if defined(_MSC_VER)
+    unsigned long ulIndex;
+    _BitScanForward(&ulIndex, ulBits);
+    return (UBaseType_t)ulIndex;
+#else
+    return (UBaseType_t)__builtin_ctz(ulBits);
+#endif
+}
+
+static void prvEDF_PostDeadline(EDFTask* task, TickType_t xDeadline) {
+    if (task->next_deadline == xDeadline) {
+        return; // deadline did not move, nothing to re-rank
+    }
+    taskENTER_CRITICAL();
+    task->next_deadline = xDeadline;
+    ulEDFPending[task->index / 32] |= 1UL << (task->index % 32);
+    taskEXIT_CRITICAL();
+    if (xEDFScheduler != NULL) {
+        xTaskNotify(xEDFScheduler, 1UL << (task->index / 32), eSetBits);
     }
 }
 
-static void vEDF_TaskB(void* pvParameters) {
+static void vEDF_Task(void* pvParameters) {
     EDFTask* task = (EDFTask*)pvParameters;
     TickType_t xLastWake = xTaskGetTickCount();
     for (;;) {
-        vPrintTimestamped("%s: executing", task->name);
-        task->next_deadline = xTaskGetTickCount() + task->period;
+        // release: normally already ranked by the completion of the previous job
+        prvEDF_PostDeadline(task, xLastWake + task->deadline);
+        vJobStatsStart(&task->stats, xLastWake);
+        xLogEvent(LOG_EDF_EXECUTING, task->name);
+        if (task->model != NULL) {
+            uint32_t ulExecUs;
+            (void)xBenchNextJob(task->model, &ulExecUs); // EDF has no backup; an overrun just runs long
+            vBenchExecute(ulExecUs);
+        }
+        vJobStatsComplete(&task->stats);
+        if (xTaskGetTickCount() > xLastWake + task->deadline) {
+            task->deadlineMisses++;
+            (void)xServiceLoopPostFault(SERVICE_FAULT_DEADLINE_MISS, task->name, task->deadlineMisses);
+        }
+        // completion: rank by the deadline of the next job
+        prvEDF_PostDeadline(task, xLastWake + task->period + task->deadline);
         vTaskDelayUntil(&xLastWake, task->period);
     }
 }
 
+static void prvEDF_Rekey(UBaseType_t uxTask) {
+    taskENTER_CRITICAL();
+    TickType_t xDeadline = edfTasks[uxTask].next_deadline;
+    taskEXIT_CRITICAL();
+    xEDFQueueUpdate(&xEDFReady, uxTask, xDeadline);
+}
+
+static void prvEDF_SetPriority(UBaseType_t uxTask, UBaseType_t uxPriority) {
+    vTaskPrioritySet(edfTasks[uxTask].handle, uxPriority); // dynamic priority assignment
+}
+
 static void vEDF_Scheduler(void* pvParameters) {
     (void)pvParameters;
     for (;;) {
-        // simple reorder by deadline
-        for (int i = 0; i < 1; ++i) {
-            for (int j = i + 1; j < 2; ++j) {
-                if (edfTasks[j].next_deadline < edfTasks[i].next_deadline) {
-                    EDFTask tmp = edfTasks[i];
-                    edfTasks[i] = edfTasks[j];
-                    edfTasks[j] = tmp;
-                }
+        uint32_t ulWords = 0;
+
+        // block until some task reports a moved deadline - no periodic polling
+        xTaskNotifyWait(0, ULONG_MAX, &ulWords, portMAX_DELAY);
+        configRUN_TIME_COUNTER_TYPE ullStart = portGET_RUN_TIME_COUNTER_VALUE();
+
+        while (ulWords != 0) {
+            UBaseType_t uxWord = prvLowestSetBit(ulWords);
+            ulWords &= ulWords - 1;
+
+            taskENTER_CRITICAL();
+            uint32_t ulBits = ulEDFPending[uxWord];
+            ulEDFPending[uxWord] = 0;
+            taskEXIT_CRITICAL();
+
+            while (ulBits != 0) {
+                prvEDF_Rekey(uxWord * 32 + prvLowestSetBit(ulBits));
+                ulBits &= ulBits - 1;
+                xEDFSchedulerCost.rekeys++;
             }
         }
-        for (int i = 0; i < 2; ++i) {
-            vTaskPrioritySet(edfTasks[i].handle, 3 - i); // dynamic priority assignment
+        xEDFSchedulerCost.priorityChanges += uxEDFBandMapApply(&xEDFBands, &xEDFReady, prvEDF_SetPriority);
+
+        configRUN_TIME_COUNTER_TYPE ullCost = portGET_RUN_TIME_COUNTER_VALUE() - ullStart;
+        xEDFSchedulerCost.passes++;
+        xEDFSchedulerCost.total += ullCost;
+        if (ullCost > xEDFSchedulerCost.max) {
+            xEDFSchedulerCost.max = ullCost;
         }
-        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+}
+
+static void vEDF_Server(void* pvParameters) {
+    EDFTask* task = (EDFTask*)pvParameters;
+    EDFServerRequest xRequest;
+    for (;;) {
+        // idle until a request arrives; the arrival rule keeps or renews the budget and deadline
+        xQueueReceive(xEDFServerQueue, &xRequest, portMAX_DELAY);
+        prvEDF_PostDeadline(task, xCBSServerArrival(&xEDFServer, xTaskGetTickCount()));
+
+        // serve the backlog in one go, charging each request's CPU time as it completes
+        do {
+            configRUN_TIME_COUNTER_TYPE ullStart = ullBenchOwnRunTime();
+            xRequest.pxFunction(xRequest.pvParameter);
+            uint32_t ulUsedUs = prvCounterToUs(ullBenchOwnRunTime() - ullStart);
+            vJobHistogramAdd(&xEDFServerResponse, prvCounterToUs(portGET_RUN_TIME_COUNTER_VALUE() - xRequest.arrival));
+            ulEDFServerRequests++;
+            prvEDF_PostDeadline(task, xCBSServerCharge(&xEDFServer, ulUsedUs));
+        } while (xQueueReceive(xEDFServerQueue, &xRequest, 0) == pdPASS);
+    }
+}
+
+static BaseType_t prvEDF_ServerSubmit(void (*pxFunction)(void*), void* pvParameter) {
+    if (xEDFServerQueue == NULL) {
+        return pdFAIL; // the running demo has no server
+    }
+    EDFServerRequest xRequest = { pxFunction, pvParameter, portGET_RUN_TIME_COUNTER_VALUE() };
+    if (xQueueSend(xEDFServerQueue, &xRequest, 0) != pdPASS) {
+        ulEDFServerDropped++;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+static void prvEDF_HandleKey(void* pvParameter) {
+    xLogEvent(LOG_EDF_SERVER_KEY, (unsigned long)(uintptr_t)pvParameter);
+    vBenchExecute(EDF_SERVER_KEY_WORK_US);
+}
+
+/* Called from main.c's key handler task: every key becomes an aperiodic request for the
+   EDF server. */
+void vBlinkyKeyHandler(int xKeyPressed) {
+    (void)prvEDF_ServerSubmit(prvEDF_HandleKey, (void*)(uintptr_t)xKeyPressed);
+}
+
+/* Service timer: summary every 5 seconds. */
+static void prvEDF_Report(void* pvContext) {
+    (void)pvContext;
+    xLogEvent(LOG_EDF_SUMMARY_HEADER);
+    for (UBaseType_t i = 0; i < uxEDFTaskCount; ++i) {
+        xLogEvent(LOG_EDF_SUMMARY_TASK, edfTasks[i].name, (unsigned long)edfTasks[i].stats.jobs);
+        prvReportJobStats(edfTasks[i].name, &edfTasks[i].stats);
+    }
+    if (pxEDFServerTask != NULL) {
+        xLogEvent(LOG_EDF_SERVER_SUMMARY, pxEDFServerTask->name,
+            (unsigned long)ulEDFServerRequests,
+            (unsigned long)ulEDFServerDropped,
+            (unsigned long)xEDFServer.replenishments);
+        xLogEvent(LOG_JOB_RESPONSE, pxEDFServerTask->name,
+            (unsigned long)ulJobHistogramPercentile(&xEDFServerResponse, 50),
+            (unsigned long)ulJobHistogramPercentile(&xEDFServerResponse, 99),
+            (unsigned long)xEDFServerResponse.max);
+    }
+    vLogRequestFlush(); // print the summary in one go
+}
+
+/* Admission test, then the scheduler, one task per entry of pxDefs and the aperiodic server
+   if pxServer is not NULL. pxModels gives the benchmark's job source per task, or NULL for
+   the demo. Returns pdFAIL if the set was rejected. */
+static BaseType_t prvEDF_Setup(const EDFTaskDef* pxDefs, UBaseType_t uxCount, BenchJobModel* pxModels,
+    const EDFServerDef* pxServer) {
+    UBaseType_t uxEntities = uxCount + ((pxServer != NULL) ? 1 : 0);
+    configASSERT(uxEntities <= EDF_MAX_TASKS);
+
+    // check the declared set before creating anything
+    static EDFTaskSpec xSpecs[EDF_MAX_TASKS];
+    EDFAdmissionReport xReport;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        xSpecs[i].name = pxDefs[i].name;
+        xSpecs[i].period = pdMS_TO_TICKS(pxDefs[i].periodMs);
+        xSpecs[i].deadline = pdMS_TO_TICKS(pxDefs[i].deadlineMs);
+        xSpecs[i].wcet = pdMS_TO_TICKS(pxDefs[i].wcetMs);
+    }
+    if (pxServer != NULL) {
+        xSpecs[uxCount].name = pxServer->name;
+        xSpecs[uxCount].period = pdMS_TO_TICKS(pxServer->periodMs);
+        xSpecs[uxCount].deadline = xSpecs[uxCount].period;
+        xSpecs[uxCount].wcet = pdMS_TO_TICKS((pxServer->budgetUs + 999) / 1000);
+    }
+    BaseType_t xAdmitted = xEDFAdmissionTest(xSpecs, uxEntities, &xReport);
+    vEDFAdmissionPrint("EDF", xSpecs, uxEntities, &xReport);
+    if (xAdmitted == pdFAIL && EDF_ADMISSION_REJECT) {
+        return pdFAIL;
+    }
+
+    vEDFQueueInit(&xEDFReady);
+    vEDFBandMapInit(&xEDFBands, EDF_BAND_LOWEST_PRIORITY, EDF_BAND_HIGHEST_PRIORITY);
+
+    // scheduler first so the tasks can notify it from their first release
+    xEDFScheduler = prvCreateAuditedTask(vEDF_Scheduler, "EDF_Scheduler", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1);
+
+    uxEDFTaskCount = uxCount;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        edfTasks[i].period = xSpecs[i].period;
+        edfTasks[i].deadline = xSpecs[i].deadline;
+        edfTasks[i].name = pxDefs[i].name;
+        edfTasks[i].index = i;
+        edfTasks[i].model = (pxModels != NULL) ? &pxModels[i] : NULL;
+        vJobStatsInit(&edfTasks[i].stats, edfTasks[i].period);
+        xEDFQueueInsert(&xEDFReady, i, edfTasks[i].next_deadline);
+        edfTasks[i].handle = xBlockPoolCreateTask(vEDF_Task, edfTasks[i].name, configMINIMAL_STACK_SIZE, &edfTasks[i], EDF_BAND_LOWEST_PRIORITY);
+        configASSERT(edfTasks[i].handle != NULL);
+    }
+
+    if (pxServer != NULL) {
+        static StaticQueue_t xServerQueueBuffer;
+        static uint8_t ucServerQueueStorage[EDF_SERVER_QUEUE_LENGTH * sizeof(EDFServerRequest)];
+        EDFTask* t = &edfTasks[uxCount];
+
+        vCBSServerInit(&xEDFServer, pxServer->budgetUs, xSpecs[uxCount].period);
+        xEDFServerQueue = xQueueCreateStatic(EDF_SERVER_QUEUE_LENGTH, sizeof(EDFServerRequest), ucServerQueueStorage, &xServerQueueBuffer);
+        t->period = t->deadline = xSpecs[uxCount].period;
+        t->name = pxServer->name;
+        t->index = uxCount;
+        t->model = NULL;
+        t->next_deadline = portMAX_DELAY; // ranks last until the first request
+        vJobStatsInit(&t->stats, t->period);
+        xEDFQueueInsert(&xEDFReady, uxCount, t->next_deadline);
+        pxEDFServerTask = t;
+        t->handle = xBlockPoolCreateTask(vEDF_Server, t->name, configMINIMAL_STACK_SIZE, t, EDF_BAND_LOWEST_PRIORITY);
+        configASSERT(t->handle != NULL);
+    }
+    return pdPASS;
+}
+
+/* Metrics source: jobs and deadline misses per EDF task. */
+static void prvEDF_Metrics(MetricsText* pxText) {
+    vMetricsTextAppend(pxText, "# TYPE edf_jobs_total counter\n");
+    for (UBaseType_t i = 0; i < uxEDFTaskCount; ++i) {
+        vMetricsTextAppend(pxText, "edf_jobs_total{task=\"%s\"} %lu\n", edfTasks[i].name, (unsigned long)edfTasks[i].stats.jobs);
+    }
+    vMetricsTextAppend(pxText, "# TYPE edf_deadline_misses_total counter\n");
+    for (UBaseType_t i = 0; i < uxEDFTaskCount; ++i) {
+        vMetricsTextAppend(pxText, "edf_deadline_misses_total{task=\"%s\"} %lu\n", edfTasks[i].name, (unsigned long)edfTasks[i].deadlineMisses);
+    }
+    if (pxEDFServerTask != NULL) {
+        vMetricsTextAppend(pxText, "# TYPE edf_server_requests_total counter\nedf_server_requests_total %lu\n",
+            (unsigned long)ulEDFServerRequests);
+        vMetricsTextAppend(pxText, "# TYPE edf_server_dropped_total counter\nedf_server_dropped_total %lu\n",
+            (unsigned long)ulEDFServerDropped);
     }
 }
 
@@ -84,16 +448,17 @@ void main_blinky(void) {
     /* This function is left as a simple EDF demo entry.
        To run other demos, change the call in main.c (see instructions). */
     srand((unsigned)time(NULL));
-    edfTasks[0].period = pdMS_TO_TICKS(300);
-    edfTasks[0].name = "EDF_TaskA";
-    xTaskCreate(vEDF_TaskA, edfTasks[0].name, configMINIMAL_STACK_SIZE, &edfTasks[0], 1, &edfTasks[0].handle);
 
-    edfTasks[1].period = pdMS_TO_TICKS(500);
-    edfTasks[1].name = "EDF_TaskB";
-    xTaskCreate(vEDF_TaskB, edfTasks[1].name, configMINIMAL_STACK_SIZE, &edfTasks[1], 1, &edfTasks[1].handle);
+    if (prvEDF_Setup(edfTaskSet, NUM_EDF_TASKS, NULL, &edfServerDef) == pdFAIL) {
+        return;
+    }
 
-    xTaskCreate(vEDF_Scheduler, "EDF_Scheduler", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL);
+    BaseType_t xAdded = xServiceLoopAddTimer("EDF_Report", 5000, prvEDF_Report, NULL);
+    configASSERT(xAdded == pdPASS);
+    (void)xAdded;
+    (void)xMetricsExportAddSource(prvEDF_Metrics);
 
+    vLogInit();
     vTaskStartScheduler();
 }
 
@@ -101,131 +466,524 @@ void main_blinky(void) {
    11) Fault-Tolerant EDF Demo
    ---------------------------- */
 
+   /* Primary/backup protocol:
+      - at each release the primary arms its backup with the job's absolute deadline
+      - on success the primary cancels the backup; the state change and the wake-up
+        (release and cancel event channels) are made under a critical section, so a cancel and an expiry
+        racing at the deadline resolve to exactly one outcome
+      - the backup sleeps until it is armed, then until the deadline or a cancel; it only
+        runs when the deadline really expires with the job still armed
+
+      Mixed criticality (AMC):
+      - every job is LO or HI criticality and declares a LO budget and a HI budget
+      - a HI job still running when its LO budget is used up switches the system to HI mode
+      - in HI mode LO primaries drop their releases and LO backups drop their firings
+      - the first instant with no primary in flight and no backup armed or running switches
+        back to LO mode
+
+      Budget enforcement:
+      - every primary job has a budget: its HI budget for HI jobs, its LO budget otherwise
+      - vBlinkyTickHookFunction() checks each job in flight against it on every tick; a job
+        over budget is stopped at its next step and its armed backup is released there and
+        then, instead of at the deadline
+      - the clock is the primary's run-time counter in the benchmark, where jobs burn their
+        work on the CPU, and the time since release in the demo, where they sleep it
+   */
+
+typedef enum {
+    FT_CRIT_LO = 0,
+    FT_CRIT_HI
+} FTCriticality;
+
+typedef enum {
+    FT_BACKUP_IDLE = 0,
+    FT_BACKUP_ARMED,     // primary job in flight, backup waiting for its deadline
+    FT_BACKUP_CANCELLED, // primary succeeded before the deadline
+    FT_BACKUP_FIRED      // deadline expired, backup job running
+} FTBackupState;
+
+// counters of FaultTolerantTask.primaryStats, written by the primary only
+enum { FT_STAT_SUCCESSES = 0, FT_STAT_MISSES, FT_STAT_SHED, FT_STAT_LAST_SUCCESS };
+// .backupStats, written by the backup only
+enum { FT_STAT_ACTIVATIONS = 0, FT_STAT_DEGRADED };
+// .budgetStats, written by the tick hook only
+enum { FT_STAT_BUDGET_STOPS = 0 };
+
 typedef struct {
     TaskHandle_t primaryHandle;
     TaskHandle_t backupHandle;
     TickType_t period;     // period of primary
     TickType_t deadline;   // relative time backups wait before activation
     const char* name;
-    BaseType_t primarySuccess; // result of last primary run
-    // stats:
+    // stats, one seqlock block per writer; read them through prvFT_Snapshot():
+    SeqStats primaryStats;
+    SeqStats backupStats;
+    SeqStats budgetStats;
+    JobStats stats; // response time / jitter of the primary's jobs
+    // primary/backup protocol, only changed inside critical sections:
+    volatile FTBackupState backupState;
+    TickType_t backupDeadline; // absolute tick the armed job is due by
+    volatile BaseType_t primaryBusy; // released job not finished yet
+    // mixed criticality:
+    FTCriticality criticality;
+    uint32_t loBudgetUs;  // a HI job running past this switches to HI mode
+    // budget enforcement, the flag is set by the tick hook:
+    configRUN_TIME_COUNTER_TYPE jobStart; // job clock at release
+    configRUN_TIME_COUNTER_TYPE budget;   // in run-time counter units
+    volatile BaseType_t budgetExceeded;
+    BenchJobModel* model;      // job source in the benchmark, NULL in the demo
+    // fault injection, private to the primary:
+    Prng prng;
+    uint32_t overrunPermille;
+} FaultTolerantTask;
+
+/* One consistent view of a FaultTolerantTask's counters. */
+typedef struct {
     uint32_t successCount;
     uint32_t backupActivations;
     uint32_t deadlineMisses;
-} FaultTolerantTask;
+    uint32_t droppedJobs; // LO jobs shed while in HI mode, released or at their backup
+    uint32_t budgetStops;
+    BaseType_t primarySuccess; // result of the last primary job
+} FTStatsSnapshot;
+
+typedef struct {
+    const char* name;
+    uint32_t periodMs;
+    uint32_t deadlineMs;
+    FTCriticality criticality;
+    uint32_t loBudgetMs; // declared budgets, used by the admission test
+    uint32_t hiBudgetMs; // HI jobs only; LO jobs never run in HI mode
+    uint32_t backupBudgetMs;
+    uint32_t overrunPermille; // chance that a primary job overruns (demo only)
+} FTTaskDef;
+
+// each job may need its primary budget (period/2) plus the backup budget (period/4);
+// in HI mode only JobA runs, with up to 350 ms before its backup
+// JobB's normal job (period/2) takes its whole LO budget: charged in ticks with
+// FT_BUDGET_SLACK_US on top, it completes before the tick hook could stop it. The declared
+// budgets the admission test sees are unchanged.
+static const FTTaskDef ftTaskSet[NUM_FT_TASKS] = {
+    { "JobA", 500, 800, FT_CRIT_HI, 250, 350, 125, 100 },
+    { "JobB", 700, 1000, FT_CRIT_LO, 350, 350, 175, 100 },
+};
+
+static FaultTolerantTask ftTasks[FT_MAX_TASKS];
+static UBaseType_t uxFTTaskCount = 0;
+
+static volatile FTCriticality xFTMode = FT_CRIT_LO; // system criticality mode
+static uint32_t ulFTModeSwitches = 0;
+
+static void prvFT_EnterHiMode(const FaultTolerantTask* task) {
+    BaseType_t xSwitched = pdFALSE;
+    taskENTER_CRITICAL();
+    if (xFTMode == FT_CRIT_LO) {
+        xFTMode = FT_CRIT_HI;
+        ulFTModeSwitches++;
+        xSwitched = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+    if (xSwitched == pdTRUE) {
+        xLogEvent(LOG_FT_MODE_HI, task->name, (unsigned long)xTaskGetTickCount());
+    }
+}
+
+// Called whenever a primary or backup job ends: back to LO mode once nothing is pending.
+static void prvFT_CheckIdleInstant(void) {
+    BaseType_t xRestored = pdFALSE;
+    taskENTER_CRITICAL();
+    if (xFTMode == FT_CRIT_HI) {
+        BaseType_t xPending = pdFALSE;
+        for (UBaseType_t i = 0; i < uxFTTaskCount && !xPending; ++i) {
+            const FaultTolerantTask* t = &ftTasks[i];
+            xPending = t->primaryBusy || t->backupState == FT_BACKUP_ARMED || t->backupState == FT_BACKUP_FIRED;
+        }
+        if (!xPending) {
+            xFTMode = FT_CRIT_LO;
+            xRestored = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+    if (xRestored == pdTRUE) {
+        xLogEvent(LOG_FT_MODE_LO, (unsigned long)xTaskGetTickCount());
+    }
+}
+
+// The job clock budgets are charged against, in run-time counter units. Also called from the
+// tick hook. Demo jobs sleep their work off in ticks, so their clock is the tick count: the
+// counter runs on host time, which the simulated ticks lag, and would charge that lag too.
+static configRUN_TIME_COUNTER_TYPE prvFT_JobClock(const FaultTolerantTask* task) {
+    if (task->model == NULL) {
+        return (configRUN_TIME_COUNTER_TYPE)xTaskGetTickCountFromISR() * (configRUN_TIME_COUNTER_HZ / configTICK_RATE_HZ);
+    }
+    configRUN_TIME_COUNTER_TYPE ullNow = portGET_RUN_TIME_COUNTER_VALUE();
+    configRUN_TIME_COUNTER_TYPE ullRunTime = ulTaskGetRunTimeCounter(task->primaryHandle);
+    if (task->primaryHandle == xTaskGetCurrentTaskHandle()) {
+        ullRunTime += ullNow - ullBenchSwitchedInAt; // the slice it is in now
+    }
+    return ullRunTime;
+}
+
+// Simulated work: burnt on the CPU in the benchmark, slept in the demo. Returns pdFALSE if
+// the tick hook stopped the job on its budget.
+static BaseType_t prvFT_Work(FaultTolerantTask* task, uint32_t ulUs) {
+    if (ulUs == 0) {
+        return (task->budgetExceeded == pdFALSE) ? pdTRUE : pdFALSE;
+    }
+    if (task->model != NULL) {
+        return xBenchExecuteUnless(ulUs, &task->budgetExceeded);
+    }
+    EventChannelEvents xEvents;
+    (void)ulEventChannelWait(EVENT_CHANNEL_BIT(EVENT_CHANNEL_CANCEL), &xEvents, pdMS_TO_TICKS(ulUs / 1000)); // the tick hook's stop ends the sleep early
+    return (task->budgetExceeded == pdFALSE) ? pdTRUE : pdFALSE;
+}
+
+// Runs a job of ulWorkUs, checking it against the LO budget on the way. Returns pdFALSE if
+// it was stopped before finishing.
+static BaseType_t prvFT_RunJob(FaultTolerantTask* task, uint32_t ulWorkUs) {
+    uint32_t ulLoUs = (ulWorkUs < task->loBudgetUs) ? ulWorkUs : task->loBudgetUs;
+    if (prvFT_Work(task, ulLoUs) == pdFALSE) {
+        return pdFALSE;
+    }
+    if (ulWorkUs > ulLoUs) {
+        if (task->criticality == FT_CRIT_HI) {
+            prvFT_EnterHiMode(task);
+        }
+        return prvFT_Work(task, ulWorkUs - ulLoUs);
+    }
+    return pdTRUE;
+}
+
+// Budget check of every FT job in flight, run from vApplicationTickHook() in main.c.
+void vBlinkyTickHookFunction(void) {
+    BaseType_t xWoken = pdFALSE;
+    for (UBaseType_t i = 0; i < uxFTTaskCount; ++i) {
+        FaultTolerantTask* t = &ftTasks[i];
+        if (t->primaryBusy == pdFALSE || t->budgetExceeded != pdFALSE
+            || prvFT_JobClock(t) - t->jobStart <= t->budget) {
+            continue;
+        }
+        t->budgetExceeded = pdTRUE;
+        vSeqStatsAdd(&t->budgetStats, FT_STAT_BUDGET_STOPS, 1);
+        if (t->backupState == FT_BACKUP_ARMED) {
+            t->backupDeadline = xTaskGetTickCountFromISR(); // due now rather than at the deadline
+            vEventChannelPostFromISR(t->backupHandle, EVENT_CHANNEL_RELEASE, 1, &xWoken);
+        }
+        vEventChannelPostFromISR(t->primaryHandle, EVENT_CHANNEL_CANCEL, 1, &xWoken);
+    }
+    (void)xWoken; // a task readied from the tick hook is switched to as the tick returns
+}
+
+static void prvFT_ArmBackup(FaultTolerantTask* task, TickType_t xDeadline) {
+    taskENTER_CRITICAL();
+    if (task->backupState != FT_BACKUP_ARMED) {
+        task->backupDeadline = xDeadline;
+    } // else a failed job is still waiting for its (earlier) deadline; that firing covers this one
+    task->backupState = FT_BACKUP_ARMED;
+    taskEXIT_CRITICAL();
+    vEventChannelPost(task->backupHandle, EVENT_CHANNEL_RELEASE, 1);
+}
 
-static FaultTolerantTask ftTasks[NUM_FT_TASKS];
+static void prvFT_CancelBackup(FaultTolerantTask* task) {
+    BaseType_t xCancelled = pdFALSE;
+    taskENTER_CRITICAL();
+    if (task->backupState == FT_BACKUP_ARMED) {
+        task->backupState = FT_BACKUP_CANCELLED;
+        xCancelled = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+    if (xCancelled == pdTRUE) {
+        vEventChannelPost(task->backupHandle, EVENT_CHANNEL_CANCEL, 1);
+    }
+}
 
 static void vFT_Primary(void* pvParameters) {
     FaultTolerantTask* task = (FaultTolerantTask*)pvParameters;
     TickType_t xNextWake = xTaskGetTickCount();
     for (;;) {
-        // start of cycle: assume fail until proven otherwise
-        task->primarySuccess = pdFALSE;
+        BaseType_t xSuccess = pdFALSE; // assume fail until proven otherwise
+        BaseType_t xMissed = pdFALSE;
         vTaskDelayUntil(&xNextWake, task->period); // periodic release
 
-        vPrintTimestamped("[%s] Primary started", task->name);
+        if (task->criticality == FT_CRIT_LO && xFTMode == FT_CRIT_HI) {
+            vSeqStatsAdd(&task->primaryStats, FT_STAT_SHED, 1); // shed until the next idle instant
+            continue;
+        }
+        EventChannelEvents xEvents;
+        (void)ulEventChannelWait(EVENT_CHANNEL_BIT(EVENT_CHANNEL_CANCEL), &xEvents, 0); // drop a stop that came after the last job ended
+        taskENTER_CRITICAL();
+        task->jobStart = prvFT_JobClock(task);
+        task->budgetExceeded = pdFALSE;
+        task->primaryBusy = pdTRUE;
+        taskEXIT_CRITICAL();
+
+        prvFT_ArmBackup(task, xNextWake + pdMS_TO_TICKS(task->deadline));
+        vJobStatsStart(&task->stats, xNextWake);
+        xLogEvent(LOG_FT_PRIMARY_STARTED, task->name);
 
-        // simulate random overrun (10% chance)
-        if ((rand() % 10) == 0) {
-            // take longer than deadline (overrun)
-            vTaskDelay(pdMS_TO_TICKS((task->deadline * 2) / 1)); // big overrun
-            vPrintTimestamped("[%s] Primary: OVERRUN", task->name);
-            task->primarySuccess = pdFALSE;
+        // simulate random overrun from the task's own stream, or draw the job in the benchmark
+        uint32_t ulExecUs = 0;
+        BaseType_t xOverrun = (task->model != NULL) ? xBenchNextJob(task->model, &ulExecUs)
+                                                    : xPrngChance(&task->prng, task->overrunPermille);
+        // faulty jobs take longer than the deadline (overrun) unless the budget stops them first
+        uint32_t ulWorkUs = (task->model != NULL) ? ulExecUs
+            : (xOverrun ? task->deadline * 2 * 1000 : (task->period / 2) * portTICK_PERIOD_MS * 1000);
+        BaseType_t xCompleted = prvFT_RunJob(task, ulWorkUs);
+        if (task->budgetExceeded != pdFALSE) {
+            xLogEvent(LOG_FT_BUDGET_STOPPED, task->name, (unsigned long)xTaskGetTickCount());
+            (void)xServiceLoopPostFault(SERVICE_FAULT_OVERRUN, task->name, task->budgetStats.value[FT_STAT_BUDGET_STOPS]);
+        }
+        else if (xOverrun || !xCompleted) {
+            xLogEvent(LOG_FT_PRIMARY_OVERRUN, task->name);
+            (void)xServiceLoopPostFault(SERVICE_FAULT_OVERRUN, task->name, 0);
         }
         else {
-            // normal execution shorter than deadline
-            vTaskDelay(pdMS_TO_TICKS(task->period / 2));
-            task->primarySuccess = pdTRUE;
-            task->successCount++;
-            vPrintTimestamped("[%s] Primary: SUCCESS", task->name);
+            xSuccess = pdTRUE;
+            prvFT_CancelBackup(task);
+            xLogEvent(LOG_FT_PRIMARY_SUCCESS, task->name);
         }
 
+        vJobStatsComplete(&task->stats);
+
         // If primary succeeded, nothing for backup to do this cycle.
         // Just log. Deadline misses:
         TickType_t now = xTaskGetTickCount();
-        if (now > (xNextWake - task->period + task->deadline)) {
+        if (now > (xNextWake + pdMS_TO_TICKS(task->deadline))) {
             // if now is past the deadline relative to cycle start
-            if (!task->primarySuccess) {
-                task->deadlineMisses++;
-                vPrintTimestamped("[%s] ⚠️ PRIMARY missed deadline (primarySuccess=false) at %lu", task->name, (unsigned long)now);
+            xMissed = pdTRUE;
+            if (!xSuccess) {
+                xLogEvent(LOG_FT_PRIMARY_MISSED, task->name, (unsigned long)now);
             }
             else {
                 // if primary succeeded but still past deadline it means it finished late
                 // count as missed as well
-                task->deadlineMisses++;
-                vPrintTimestamped("[%s] ⚠️ PRIMARY finished after deadline (late success) at %lu", task->name, (unsigned long)now);
+                xLogEvent(LOG_FT_PRIMARY_LATE, task->name, (unsigned long)now);
             }
         }
 
-        // Primary does NOT directly suspend backup — backup checks primarySuccess at its activation time.
+        // the job's outcome goes in as one update, so readers never see half of it
+        vSeqStatsWriteBegin(&task->primaryStats);
+        task->primaryStats.value[FT_STAT_SUCCESSES] += (xSuccess == pdTRUE) ? 1 : 0;
+        task->primaryStats.value[FT_STAT_MISSES] += (xMissed == pdTRUE) ? 1 : 0;
+        task->primaryStats.value[FT_STAT_LAST_SUCCESS] = (uint32_t)xSuccess;
+        vSeqStatsWriteEnd(&task->primaryStats);
+        if (xMissed == pdTRUE) {
+            (void)xServiceLoopPostFault(SERVICE_FAULT_DEADLINE_MISS, task->name, task->primaryStats.value[FT_STAT_MISSES]);
+        }
+
+        // A failed job leaves the backup armed; it takes over when the deadline expires, or has
+        // already if the budget stopped the job.
+        task->primaryBusy = pdFALSE;
+        prvFT_CheckIdleInstant();
     }
 }
 
 static void vFT_Backup(void* pvParameters) {
     FaultTolerantTask* task = (FaultTolerantTask*)pvParameters;
+    const uint32_t ulChannels = EVENT_CHANNEL_BIT(EVENT_CHANNEL_RELEASE) | EVENT_CHANNEL_BIT(EVENT_CHANNEL_CANCEL);
+    EventChannelEvents xEvents;
     for (;;) {
-        // Backup waits "deadline" ticks from its last activation time.
-        vTaskDelay(pdMS_TO_TICKS(task->deadline));
+        // Sleep until the primary arms a job - no periodic wake-ups. The state decides
+        // what to do; the events only wake us, however many of them piled up.
+        while (task->backupState != FT_BACKUP_ARMED) {
+            (void)ulEventChannelWait(ulChannels, &xEvents, portMAX_DELAY);
+        }
+
+        // Then until its deadline, unless the primary cancels first.
+        for (;;) {
+            TickType_t xNow = xTaskGetTickCount();
+            if (xNow >= task->backupDeadline || task->backupState != FT_BACKUP_ARMED) {
+                break;
+            }
+            (void)ulEventChannelWait(ulChannels, &xEvents, task->backupDeadline - xNow);
+        }
+
+        BaseType_t xFire = pdFALSE;
+        taskENTER_CRITICAL();
+        if (task->backupState == FT_BACKUP_ARMED) {
+            task->backupState = FT_BACKUP_FIRED;
+            xFire = pdTRUE;
+        }
+        taskEXIT_CRITICAL();
 
-        // If primary didn't succeed this cycle, backup activates.
-        if (!task->primarySuccess) {
-            task->backupActivations++;
-            vPrintTimestamped("[%s] BACKUP activated (primary failed)", task->name);
+        if (xFire == pdTRUE && task->criticality == FT_CRIT_LO && xFTMode == FT_CRIT_HI) {
+            vSeqStatsAdd(&task->backupStats, FT_STAT_DEGRADED, 1); // a LO job gets no backup in HI mode
+        }
+        else if (xFire == pdTRUE) {
+            vSeqStatsAdd(&task->backupStats, FT_STAT_ACTIVATIONS, 1);
+            xLogEvent(LOG_FT_BACKUP_ACTIVATED, task->name);
+            (void)xServiceLoopPostFault(SERVICE_FAULT_BACKUP, task->name, task->backupStats.value[FT_STAT_ACTIVATIONS]);
             // Simulate backup execution (lighter)
-            vTaskDelay(pdMS_TO_TICKS(task->period / 4));
+            if (task->model != NULL) {
+                vBenchExecute(task->model->spec->backupExecUs);
+            }
+            else {
+                vTaskDelay(pdMS_TO_TICKS(task->period / 4));
+            }
         }
-        else {
-            // primary succeeded -> backup cancels itself for this cycle
-            vPrintTimestamped("[%s] Backup checked: primary succeeded -> skipping", task->name);
+
+        if (xFire == pdTRUE) {
+            taskENTER_CRITICAL();
+            if (task->backupState == FT_BACKUP_FIRED) {
+                task->backupState = FT_BACKUP_IDLE; // unless the primary re-armed meanwhile
+            }
+            taskEXIT_CRITICAL();
+            prvFT_CheckIdleInstant();
         }
-        // loop: will delay again for next cycle
     }
 }
 
-static void vFT_Monitor(void* pvParameters) {
-    (void)pvParameters;
-    for (;;) {
-        vTaskDelay(pdMS_TO_TICKS(5000)); // print summary every 5 seconds
-        vPrintTimestamped("---- Fault Tolerant EDF Summary ----");
-        for (int i = 0; i < NUM_FT_TASKS; ++i) {
-            FaultTolerantTask* t = &ftTasks[i];
-            printf("  [%s] successes=%lu backups=%lu deadline_misses=%lu\n",
-                t->name,
-                (unsigned long)t->successCount,
-                (unsigned long)t->backupActivations,
-                (unsigned long)t->deadlineMisses);
-        }
-    }
+/* Read the three counter blocks of t without stopping its writers. Returns pdFAIL if a
+   block could only be read torn (see xSeqStatsRead()). */
+static BaseType_t prvFT_Snapshot(const FaultTolerantTask* t, FTStatsSnapshot* pxSnapshot) {
+    uint32_t ulPrimary[SEQ_STATS_MAX_COUNTERS];
+    uint32_t ulBackup[SEQ_STATS_MAX_COUNTERS];
+    uint32_t ulBudget[SEQ_STATS_MAX_COUNTERS];
+    BaseType_t xConsistent = xSeqStatsRead(&t->primaryStats, ulPrimary);
+    xConsistent &= xSeqStatsRead(&t->backupStats, ulBackup);
+    xConsistent &= xSeqStatsRead(&t->budgetStats, ulBudget);
+
+    pxSnapshot->successCount = ulPrimary[FT_STAT_SUCCESSES];
+    pxSnapshot->deadlineMisses = ulPrimary[FT_STAT_MISSES];
+    pxSnapshot->primarySuccess = (BaseType_t)ulPrimary[FT_STAT_LAST_SUCCESS];
+    pxSnapshot->backupActivations = ulBackup[FT_STAT_ACTIVATIONS];
+    pxSnapshot->droppedJobs = ulPrimary[FT_STAT_SHED] + ulBackup[FT_STAT_DEGRADED];
+    pxSnapshot->budgetStops = ulBudget[FT_STAT_BUDGET_STOPS];
+    return xConsistent;
 }
 
-void main_fault_tolerant_demo(void) {
-    srand((unsigned)time(NULL));
+/* Service timer: summary every 5 seconds. */
+static void prvFT_Report(void* pvContext) {
+    (void)pvContext;
+    xLogEvent(LOG_FT_SUMMARY_HEADER);
+    xLogEvent(LOG_FT_SUMMARY_MODE, (xFTMode == FT_CRIT_HI) ? "HI" : "LO", (unsigned long)ulFTModeSwitches);
+    for (UBaseType_t i = 0; i < uxFTTaskCount; ++i) {
+        FaultTolerantTask* t = &ftTasks[i];
+        FTStatsSnapshot xSnapshot;
+        (void)prvFT_Snapshot(t, &xSnapshot); // the writers outrank this task, so never torn
+        xLogEvent(LOG_FT_SUMMARY_TASK,
+            t->name,
+            (unsigned long)xSnapshot.successCount,
+            (unsigned long)xSnapshot.backupActivations,
+            (unsigned long)xSnapshot.deadlineMisses,
+            (unsigned long)xSnapshot.droppedJobs,
+            (unsigned long)xSnapshot.budgetStops);
+        prvReportJobStats(t->name, &t->stats);
+    }
+    prvReportHeapStats();
+    prvReportBlockPools();
+    vServiceLoopReportFaults();
+    vLogRequestFlush(); // print the summary in one go
+}
 
-    // Configure two FT tasks
-    ftTasks[0].name = "JobA";
-    ftTasks[0].period = 500;   // ms
-    ftTasks[0].deadline = 800; // ms
-    ftTasks[0].primarySuccess = pdTRUE;
-    ftTasks[0].successCount = ftTasks[0].backupActivations = ftTasks[0].deadlineMisses = 0;
+/* Admission test, then a primary and a backup per entry of pxDefs. pxModels gives the
+   benchmark's job source per job, or NULL for the demo. Primary i injects its faults from
+   stream i of ulSeed. Returns pdFAIL if the set was rejected. */
+static BaseType_t prvFT_Setup(const FTTaskDef* pxDefs, UBaseType_t uxCount, BenchJobModel* pxModels, uint32_t ulSeed) {
+    configASSERT(uxCount <= FT_MAX_TASKS);
 
-    ftTasks[1].name = "JobB";
-    ftTasks[1].period = 700;   // ms
-    ftTasks[1].deadline = 1000; // ms
-    ftTasks[1].primarySuccess = pdTRUE;
-    ftTasks[1].successCount = ftTasks[1].backupActivations = ftTasks[1].deadlineMisses = 0;
+    // admission, once per mode: in LO mode every job may need its LO budget plus its backup
+    // budget, in HI mode every HI job its HI budget plus its backup budget. This checks each
+    // mode on its own; the jobs carried across a switch are not covered.
+    static EDFTaskSpec xSpecs[2 * FT_MAX_TASKS];
+    EDFAdmissionReport xReport;
+    BaseType_t xAdmitted = pdPASS;
+    for (FTCriticality xMode = FT_CRIT_LO; xMode <= FT_CRIT_HI; ++xMode) {
+        UBaseType_t n = 0;
+        for (UBaseType_t i = 0; i < uxCount; ++i) {
+            if (pxDefs[i].criticality < xMode) {
+                continue;
+            }
+            xSpecs[n].name = pxDefs[i].name;
+            xSpecs[n].period = pdMS_TO_TICKS(pxDefs[i].periodMs);
+            xSpecs[n].deadline = pdMS_TO_TICKS(pxDefs[i].deadlineMs);
+            xSpecs[n].wcet = pdMS_TO_TICKS((xMode == FT_CRIT_HI) ? pxDefs[i].hiBudgetMs : pxDefs[i].loBudgetMs);
+            xSpecs[n + 1] = xSpecs[n];
+            xSpecs[n + 1].name = "FT_Backup";
+            xSpecs[n + 1].wcet = pdMS_TO_TICKS(pxDefs[i].backupBudgetMs);
+            n += 2;
+        }
+        if (n == 0) {
+            continue;
+        }
+        if (xEDFAdmissionTest(xSpecs, n, &xReport) == pdFAIL) {
+            xAdmitted = pdFAIL;
+        }
+        vEDFAdmissionPrint((xMode == FT_CRIT_HI) ? "Fault-Tolerant EDF (HI mode)" : "Fault-Tolerant EDF (LO mode)",
+            xSpecs, n, &xReport);
+    }
+    if (xAdmitted == pdFAIL && EDF_ADMISSION_REJECT) {
+        return pdFAIL;
+    }
 
     // create tasks (primary & backup)
-    for (int i = 0; i < NUM_FT_TASKS; ++i) {
-        // convert ms to ticks in the task's fields for portability
-        ftTasks[i].period = pdMS_TO_TICKS(ftTasks[i].period);
-        ftTasks[i].deadline = ftTasks[i].deadline; // keep in ms; Backup uses pdMS_TO_TICKS when delaying
-        xTaskCreate(vFT_Primary, ftTasks[i].name, configMINIMAL_STACK_SIZE + 50, &ftTasks[i], 3, &ftTasks[i].primaryHandle);
-        xTaskCreate(vFT_Backup, "FT_Backup", configMINIMAL_STACK_SIZE + 40, &ftTasks[i], 2, &ftTasks[i].backupHandle);
+    uxFTTaskCount = uxCount;
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        FaultTolerantTask* t = &ftTasks[i];
+        t->name = pxDefs[i].name;
+        t->period = pdMS_TO_TICKS(pxDefs[i].periodMs);
+        t->deadline = pxDefs[i].deadlineMs; // keep in ms; Backup uses pdMS_TO_TICKS when delaying
+        t->backupState = FT_BACKUP_IDLE;
+        t->primaryBusy = pdFALSE;
+        t->criticality = pxDefs[i].criticality;
+        t->loBudgetUs = pxDefs[i].loBudgetMs * 1000;
+        t->budgetExceeded = pdFALSE;
+        t->budget = (configRUN_TIME_COUNTER_TYPE)(((t->criticality == FT_CRIT_HI) ? pxDefs[i].hiBudgetMs : pxDefs[i].loBudgetMs)
+            * 1000 + FT_BUDGET_SLACK_US) * configRUN_TIME_COUNTER_HZ / 1000000ULL;
+        vSeqStatsInit(&t->primaryStats);
+        t->primaryStats.value[FT_STAT_LAST_SUCCESS] = pdTRUE;
+        vSeqStatsInit(&t->backupStats);
+        vSeqStatsInit(&t->budgetStats);
+        t->model = (pxModels != NULL) ? &pxModels[i] : NULL;
+        t->overrunPermille = pxDefs[i].overrunPermille;
+        vPrngSeed(&t->prng, ulSeed, (uint32_t)i);
+        vJobStatsInit(&t->stats, t->period);
+        // TCBs and stacks come from the fixed-size task pools, not from heap_5
+        t->primaryHandle = xBlockPoolCreateTask(vFT_Primary, t->name, configMINIMAL_STACK_SIZE + 50, t, 3);
+        t->backupHandle = xBlockPoolCreateTask(vFT_Backup, "FT_Backup", configMINIMAL_STACK_SIZE + 40, t, 2);
+        configASSERT(t->primaryHandle != NULL && t->backupHandle != NULL);
     }
+    return pdPASS;
+}
 
-    xTaskCreate(vFT_Monitor, "FT_Monitor", configMINIMAL_STACK_SIZE + 60, NULL, 1, NULL);
+/* Metrics source: the FT counters, one snapshot per task, then one family at a time. */
+static void prvFT_Metrics(MetricsText* pxText) {
+    static const char* const pcFamilies[] = {
+        "ft_successes_total", "ft_backup_activations_total", "ft_deadline_misses_total",
+        "ft_dropped_jobs_total", "ft_budget_stops_total"
+    };
+    static FTStatsSnapshot xSnapshots[FT_MAX_TASKS];
+    for (UBaseType_t i = 0; i < uxFTTaskCount; ++i) {
+        (void)prvFT_Snapshot(&ftTasks[i], &xSnapshots[i]);
+    }
+    for (UBaseType_t f = 0; f < sizeof(pcFamilies) / sizeof(pcFamilies[0]); ++f) {
+        vMetricsTextAppend(pxText, "# TYPE %s counter\n", pcFamilies[f]);
+        for (UBaseType_t i = 0; i < uxFTTaskCount; ++i) {
+            const FTStatsSnapshot* x = &xSnapshots[i];
+            const uint32_t ulValues[] = { x->successCount, x->backupActivations, x->deadlineMisses,
+                x->droppedJobs, x->budgetStops };
+            vMetricsTextAppend(pxText, "%s{task=\"%s\"} %lu\n", pcFamilies[f], ftTasks[i].name, (unsigned long)ulValues[f]);
+        }
+    }
+    vMetricsTextAppend(pxText, "# TYPE ft_mode_hi gauge\nft_mode_hi %d\n", (xFTMode == FT_CRIT_HI) ? 1 : 0);
+    vMetricsTextAppend(pxText, "# TYPE ft_mode_switches_total counter\nft_mode_switches_total %lu\n",
+        (unsigned long)ulFTModeSwitches);
+}
+
+void main_fault_tolerant_demo(void) {
+    uint32_t ulSeed = (FT_FAULT_SEED != 0) ? FT_FAULT_SEED : (uint32_t)time(NULL);
+    printf("Fault injection seed %lu (set FT_FAULT_SEED to replay)\r\n", (unsigned long)ulSeed);
+
+    if (prvFT_Setup(ftTaskSet, NUM_FT_TASKS, NULL, ulSeed) == pdFAIL) {
+        return;
+    }
 
+    BaseType_t xAdded = xServiceLoopAddTimer("FT_Report", 5000, prvFT_Report, NULL);
+    configASSERT(xAdded == pdPASS);
+    (void)xAdded;
+    (void)xMetricsExportAddSource(prvFT_Metrics);
+
+    vLogInit();
     vTaskStartScheduler();
 }
 
@@ -233,91 +991,485 @@ void main_fault_tolerant_demo(void) {
    12) Watchdog Supervisor Demo
    ---------------------------- */
 
-   /* Supervisor expects bitwise notification:
-      - bit 0 (1<<0) = heartbeat from worker1
-      - bit 1 (1<<1) = heartbeat from worker2
-      Each cycle supervisor waits up to 100 ms to collect notifications, then inspects bits.
+   /* Table-driven supervisor:
+      - every registered worker owns one bit of the supervisor's heartbeat event channel
+        (so at most 32 workers) and posts it as its heartbeat
+      - each supervisor window (WATCHDOG_WINDOW_MS) a single ulEventChannelWait collects all the
+        bits; the missing mask is walked with count-trailing-zeros, so the work per window is
+        proportional to the workers that are missing or just recovered, not to all workers
+      - a worker that stays silent for its timeout (in windows) misses a cycle; after its miss
+        threshold of consecutive cycles it is restarted
+      With WATCHDOG_ADAPTIVE the fixed window is replaced by one absolute deadline per worker:
+      - workers beat with vTaskDelayUntil and stamp xLastBeat before setting their bit
+      - the supervisor only wakes at the earliest pending deadline (kept in an EDFQueue), reads
+        the bits without blocking and moves each beaten worker's deadline to
+        last beat + mean interval + margin
+      - mean interval and margin (4x mean deviation) are learned per worker from the observed
+        intervals, Jacobson-style, so ordinary drift no longer counts as a miss
+      Workers live in statically allocated TCBs and stacks: a restart deletes the stalled task
+      and creates it again in the same memory with xTaskCreateStatic, so no restart touches
+      the heap_5 regions or waits for the idle task to free anything.
    */
 
-static TaskHandle_t xWorker1 = NULL;
-static TaskHandle_t xWorker2 = NULL;
+#define NUM_WATCHDOG_WORKERS 2
+#define WATCHDOG_ADAPTIVE 1            // 0: fixed WATCHDOG_WINDOW_MS windows
+#define WATCHDOG_WINDOW_MS 100
+#define WATCHDOG_MIN_MARGIN_MS 10      // margin never learned below this
+#define WORKER_STACK_SIZE (configMINIMAL_STACK_SIZE + 20)
+#define WORKER_PRIORITY 2
+
+#if (NUM_WATCHDOG_WORKERS > 32)
+#error "Heartbeats use one event channel bit per worker, so at most 32 workers"
+#endif
+
+typedef struct {
+    const char* name;
+    uint32_t ulPeriodMs;       // heartbeat period
+    uint32_t ulTimeoutWindows; // silent windows that count as one missed cycle (fixed windows only)
+    uint32_t ulMissThreshold;  // consecutive missed cycles before a restart
+    uint32_t ulBit;            // heartbeat bit, assigned at registration
+    TaskHandle_t handle;
+    StaticTask_t tcb;
+    StackType_t stack[WORKER_STACK_SIZE];
+    volatile uint32_t ulBeats; // heartbeats since the last (re)start, counted after xLastBeat
+    uint32_t ulIdleWindows;
+    uint32_t ulMissed;
+    uint32_t ulRestarts;
+    volatile TickType_t xLastBeat; // written by the worker before it sets its bit
+    // adaptive mode, supervisor only:
+    TickType_t xSeenBeat;      // xLastBeat at the previous check
+    uint32_t ulSeenBeats;      // ulBeats at the previous check
+    int32_t lMeanInterval8;    // mean heartbeat interval, ticks * 8
+    int32_t lDeviation4;       // mean deviation of the interval, ticks * 4 (= the margin)
+} WatchdogWorker;
+
+static WatchdogWorker xWorkers[NUM_WATCHDOG_WORKERS] = {
+    { "Worker1", 100, 1, 2 },
+    { "Worker2", 100, 1, 2 },
+};
+static uint32_t ulWatchdogRegistered = 0; // bits of all registered workers
+static uint32_t ulWatchdogIdleMask = 0;   // workers with idle windows or misses pending
 static TaskHandle_t xSupervisor = NULL;
+#if (WATCHDOG_ADAPTIVE == 1)
+static EDFQueue xWatchdogDeadlines; // worker index keyed on the tick its next beat is due by
+#endif
 
 static void vWorkerTask(void* pvParameters) {
-    const TickType_t xPeriod = pdMS_TO_TICKS(100);
-    const uint32_t ulBit = (uint32_t)pvParameters; // 1<<0 or 1<<1
+    WatchdogWorker* w = (WatchdogWorker*)pvParameters;
+    const TickType_t xPeriod = pdMS_TO_TICKS(w->ulPeriodMs);
+    TickType_t xNextBeat = xTaskGetTickCount();
     for (;;) {
+        // stamp first: a reader that sees the new count also sees this beat's tick
+        w->xLastBeat = xTaskGetTickCount();
+        w->ulBeats++;
         // send bitwise notification to supervisor
         if (xSupervisor != NULL) {
-            xTaskNotify(xSupervisor, ulBit, eSetBits);
+            vEventChannelPost(xSupervisor, EVENT_CHANNEL_HEARTBEAT, w->ulBit);
         }
-        vPrintTimestamped("Worker (bit %lu) heartbeat sent", (unsigned long)ulBit);
-        vTaskDelay(xPeriod);
+        xLogEvent(LOG_WD_HEARTBEAT, (unsigned long)w->ulBit);
+        vTaskDelayUntil(&xNextBeat, xPeriod); // no drift between beats
+    }
+}
+
+#if (WATCHDOG_ADAPTIVE == 1)
+static TickType_t prvWatchdogMargin(const WatchdogWorker* w) {
+    TickType_t xMin = pdMS_TO_TICKS(WATCHDOG_MIN_MARGIN_MS);
+    return ((TickType_t)w->lDeviation4 > xMin) ? (TickType_t)w->lDeviation4 : xMin;
+}
+
+static void prvWatchdogArm(WatchdogWorker* w, UBaseType_t uxIndex) {
+    TickType_t xDeadline = w->xSeenBeat + (TickType_t)(w->lMeanInterval8 / 8) + prvWatchdogMargin(w);
+    if (xEDFQueueUpdate(&xWatchdogDeadlines, uxIndex, xDeadline) == pdFAIL) {
+        xEDFQueueInsert(&xWatchdogDeadlines, uxIndex, xDeadline);
+    }
+}
+
+/* Fold the intervals observed since the last check into the worker's mean and deviation. */
+static void prvWatchdogLearn(WatchdogWorker* w) {
+    uint32_t ulBeats = w->ulBeats; // count before stamp, the reverse of the worker
+    TickType_t xBeat = w->xLastBeat;
+    if (ulBeats != w->ulSeenBeats) {
+        int32_t lInterval = (int32_t)((xBeat - w->xSeenBeat) / (ulBeats - w->ulSeenBeats));
+        int32_t lError = lInterval - w->lMeanInterval8 / 8;
+        w->lMeanInterval8 += lError;
+        w->lDeviation4 += ((lError < 0) ? -lError : lError) - w->lDeviation4 / 4;
+    }
+    w->xSeenBeat = xBeat;
+    w->ulSeenBeats = ulBeats;
+}
+#endif
+
+/* (Re)start a worker in its own static memory with fresh state. */
+static void prvStartWorker(WatchdogWorker* w) {
+    w->ulBeats = 0;
+    w->ulIdleWindows = 0;
+    w->ulMissed = 0;
+    w->xLastBeat = xTaskGetTickCount();
+    ulWatchdogIdleMask &= ~w->ulBit;
+#if (WATCHDOG_ADAPTIVE == 1)
+    // start from the nominal period with a margin of half a period until intervals are seen
+    w->xSeenBeat = w->xLastBeat;
+    w->ulSeenBeats = 0;
+    w->lMeanInterval8 = (int32_t)pdMS_TO_TICKS(w->ulPeriodMs) * 8;
+    w->lDeviation4 = (int32_t)pdMS_TO_TICKS(w->ulPeriodMs) / 2;
+    prvWatchdogArm(w, (UBaseType_t)(w - xWorkers));
+#endif
+    w->handle = xTaskCreateStatic(vWorkerTask, w->name, WORKER_STACK_SIZE, w, WORKER_PRIORITY, w->stack, &w->tcb);
+    configASSERT(w->handle != NULL);
+    vStackAuditRegister(w->handle, WORKER_STACK_SIZE);
+}
+
+static void prvRestartWorker(WatchdogWorker* w) {
+    if (w->handle != NULL) {
+        // deleting another task releases its TCB at once; static memory is never freed
+        vTaskDelete(w->handle);
+        w->handle = NULL;
     }
+    w->ulRestarts++;
+    (void)xServiceLoopPostFault(SERVICE_FAULT_RESTART, w->name, w->ulRestarts);
+    prvStartWorker(w);
 }
 
+/* Give the worker at table position uxIndex its heartbeat bit and start it. */
+static void prvRegisterWorker(UBaseType_t uxIndex) {
+    WatchdogWorker* w = &xWorkers[uxIndex];
+    w->ulBit = 1UL << uxIndex;
+    ulWatchdogRegistered |= w->ulBit;
+    prvStartWorker(w);
+}
+
+#if (WATCHDOG_ADAPTIVE == 1)
 static void vSupervisorTask(void* pvParameters) {
     (void)pvParameters;
-    uint32_t ulMissed1 = 0, ulMissed2 = 0;
 
     for (;;) {
+        UBaseType_t uxIndex;
         uint32_t ulReceivedBits = 0;
+        TickType_t xNow = xTaskGetTickCount();
 
-        // Wait up to 100 ms and collect any notification bits set in that period.
-        // xTaskNotifyWait will return pdTRUE if any notification arrived; the value stored
-        // in ulReceivedBits is the task's notification value (bitwise OR of set bits).
-        BaseType_t xGot = xTaskNotifyWait(0, ULONG_MAX, &ulReceivedBits, pdMS_TO_TICKS(100));
+        // sleep until the earliest deadline; heartbeats set bits but do not wake us
+        if (xEDFQueuePeekMin(&xWatchdogDeadlines, &uxIndex) == pdPASS && xEDFQueueKey(&xWatchdogDeadlines, uxIndex) > xNow) {
+            vTaskDelay(xEDFQueueKey(&xWatchdogDeadlines, uxIndex) - xNow);
+            xNow = xTaskGetTickCount();
+        }
 
-        if (xGot == pdTRUE) {
-            // check each bit
-            if (ulReceivedBits & (1UL << 0)) {
-                ulMissed1 = 0;
-            }
-            else {
-                ulMissed1++;
-            }
-            if (ulReceivedBits & (1UL << 1)) {
-                ulMissed2 = 0;
+        EventChannelEvents xEvents;
+        (void)ulEventChannelWait(EVENT_CHANNEL_BIT(EVENT_CHANNEL_HEARTBEAT), &xEvents, 0);
+        ulReceivedBits = xEvents.value[EVENT_CHANNEL_HEARTBEAT] & ulWatchdogRegistered;
+
+        // every worker that beat gets its deadline moved out from its latest beat
+        while (ulReceivedBits != 0) {
+            uxIndex = prvLowestSetBit(ulReceivedBits);
+            ulReceivedBits &= ulReceivedBits - 1;
+            WatchdogWorker* w = &xWorkers[uxIndex];
+            prvWatchdogLearn(w);
+            w->ulMissed = 0;
+            prvWatchdogArm(w, uxIndex);
+        }
+
+        // whoever is still due by now missed a cycle
+        while (xEDFQueuePeekMin(&xWatchdogDeadlines, &uxIndex) == pdPASS && xEDFQueueKey(&xWatchdogDeadlines, uxIndex) <= xNow) {
+            WatchdogWorker* w = &xWorkers[uxIndex];
+            (void)xServiceLoopPostFault(SERVICE_FAULT_HEARTBEAT, w->name, ++w->ulMissed);
+            if (w->ulMissed >= w->ulMissThreshold) {
+                xLogEvent(LOG_WD_RESTART, w->name, (unsigned long)w->ulMissed);
+                prvRestartWorker(w);
             }
             else {
-                ulMissed2++;
+                // give it one more mean interval before counting the next miss
+                xEDFQueueUpdate(&xWatchdogDeadlines, uxIndex, xEDFQueueKey(&xWatchdogDeadlines, uxIndex) + (TickType_t)(w->lMeanInterval8 / 8));
             }
         }
-        else {
-            // no notification in this 100ms window => both missed this cycle
-            ulMissed1++;
-            ulMissed2++;
+    }
+}
+#else
+static void vSupervisorTask(void* pvParameters) {
+    (void)pvParameters;
+
+    for (;;) {
+        uint32_t ulReceivedBits = 0;
+
+        // One wait per window collects the heartbeat bits of every worker; when it times out
+        // with nothing received, every registered worker is missing for this window.
+        EventChannelEvents xEvents;
+        (void)ulEventChannelWait(EVENT_CHANNEL_BIT(EVENT_CHANNEL_HEARTBEAT), &xEvents, pdMS_TO_TICKS(WATCHDOG_WINDOW_MS));
+        ulReceivedBits = xEvents.value[EVENT_CHANNEL_HEARTBEAT] & ulWatchdogRegistered;
+
+        // only workers that had something pending need their counters cleared
+        uint32_t ulRecovered = ulReceivedBits & ulWatchdogIdleMask;
+        ulWatchdogIdleMask &= ~ulReceivedBits;
+        while (ulRecovered != 0) {
+            WatchdogWorker* w = &xWorkers[prvLowestSetBit(ulRecovered)];
+            ulRecovered &= ulRecovered - 1;
+            w->ulIdleWindows = 0;
+            w->ulMissed = 0;
         }
 
-        // If any worker missed two consecutive cycles -> restart it
-        if (ulMissed1 >= 2) {
-            vPrintTimestamped("Supervisor: Restarting Worker1 (missed %lu cycles)", (unsigned long)ulMissed1);
-            if (xWorker1 != NULL) {
-                vTaskDelete(xWorker1);
+        uint32_t ulMissing = ulWatchdogRegistered & ~ulReceivedBits;
+        ulWatchdogIdleMask |= ulMissing;
+        while (ulMissing != 0) {
+            WatchdogWorker* w = &xWorkers[prvLowestSetBit(ulMissing)];
+            ulMissing &= ulMissing - 1;
+            if (++w->ulIdleWindows < w->ulTimeoutWindows) {
+                continue;
             }
-            // recreate
-            xTaskCreate(vWorkerTask, "Worker1", configMINIMAL_STACK_SIZE + 20, (void*)(uintptr_t)(1UL << 0), 2, &xWorker1);
-            ulMissed1 = 0;
-        }
-        if (ulMissed2 >= 2) {
-            vPrintTimestamped("Supervisor: Restarting Worker2 (missed %lu cycles)", (unsigned long)ulMissed2);
-            if (xWorker2 != NULL) {
-                vTaskDelete(xWorker2);
+            w->ulIdleWindows = 0;
+            // If a worker missed its threshold of consecutive cycles -> restart it
+            (void)xServiceLoopPostFault(SERVICE_FAULT_HEARTBEAT, w->name, ++w->ulMissed);
+            if (w->ulMissed >= w->ulMissThreshold) {
+                xLogEvent(LOG_WD_RESTART, w->name, (unsigned long)w->ulMissed);
+                prvRestartWorker(w);
             }
-            xTaskCreate(vWorkerTask, "Worker2", configMINIMAL_STACK_SIZE + 20, (void*)(uintptr_t)(1UL << 1), 2, &xWorker2);
-            ulMissed2 = 0;
         }
     }
 }
+#endif /* WATCHDOG_ADAPTIVE */
+
+/* Service timer: fault totals every 5 seconds. */
+static void prvWatchdogReport(void* pvContext) {
+    (void)pvContext;
+    vServiceLoopReportFaults();
+    vLogRequestFlush();
+}
+
+/* Metrics source: restarts and pending missed cycles per worker. */
+static void prvWatchdogMetrics(MetricsText* pxText) {
+    vMetricsTextAppend(pxText, "# TYPE watchdog_restarts_total counter\n");
+    for (UBaseType_t i = 0; i < NUM_WATCHDOG_WORKERS; ++i) {
+        vMetricsTextAppend(pxText, "watchdog_restarts_total{worker=\"%s\"} %lu\n", xWorkers[i].name, (unsigned long)xWorkers[i].ulRestarts);
+    }
+    vMetricsTextAppend(pxText, "# TYPE watchdog_missed_cycles gauge\n");
+    for (UBaseType_t i = 0; i < NUM_WATCHDOG_WORKERS; ++i) {
+        vMetricsTextAppend(pxText, "watchdog_missed_cycles{worker=\"%s\"} %lu\n", xWorkers[i].name, (unsigned long)xWorkers[i].ulMissed);
+    }
+}
 
 void main_watchdog_demo(void) {
     srand((unsigned)time(NULL));
     // create supervisor first so workers can notify it
-    xTaskCreate(vSupervisorTask, "Supervisor", configMINIMAL_STACK_SIZE + 50, NULL, 4, &xSupervisor);
+    xSupervisor = prvCreateAuditedTask(vSupervisorTask, "Supervisor", configMINIMAL_STACK_SIZE + 50, NULL, 4);
+
+#if (WATCHDOG_ADAPTIVE == 1)
+    vEDFQueueInit(&xWatchdogDeadlines);
+#endif
+    // register the workers: each gets its WatchdogWorker (and so its bit) via pvParameters
+    for (UBaseType_t i = 0; i < NUM_WATCHDOG_WORKERS; ++i) {
+        prvRegisterWorker(i);
+    }
+    BaseType_t xAdded = xServiceLoopAddTimer("WD_Report", 5000, prvWatchdogReport, NULL);
+    configASSERT(xAdded == pdPASS);
+    (void)xAdded;
+    (void)xMetricsExportAddSource(prvWatchdogMetrics);
+
+    vLogInit();
+    vTaskStartScheduler();
+}
+
+/* ----------------------------
+   13) Job Release Demo
+   ---------------------------- */
+
+   /* The two tasks of main_blinky.txt, a monitor and NUM_LIGHT_JOBS counters, all as jobs
+      of the release engine (job_release.c): none of them owns a task or a stack, they all
+      run on the JOB_WORKER_COUNT workers.
+   */
+
+#define NUM_BLINKY_JOBS 3
+#define NUM_LIGHT_JOBS 100
+#define JOB_MONITOR_PERIOD_MS 5000
+
+static volatile uint32_t ulLightCounter[NUM_LIGHT_JOBS];
+
+static void prvPrintJob(void* pvContext) {
+    xLogEvent(LOG_JOB_RUNNING, (const char*)pvContext);
+}
+
+static void prvLightJob(void* pvContext) {
+    ulLightCounter[(uintptr_t)pvContext]++;
+}
+
+static void prvJobMonitor(void* pvContext);
+
+static PeriodicJob xBlinkyJobs[NUM_BLINKY_JOBS] = {
+    { .name = "Task 1", .pxFunction = prvPrintJob, .pvContext = "Task 1", .period = pdMS_TO_TICKS(1000) },
+    { .name = "Task 2", .pxFunction = prvPrintJob, .pvContext = "Task 2", .period = pdMS_TO_TICKS(500) },
+    { .name = "Monitor", .pxFunction = prvJobMonitor, .period = pdMS_TO_TICKS(JOB_MONITOR_PERIOD_MS),
+      .phase = pdMS_TO_TICKS(JOB_MONITOR_PERIOD_MS) },
+};
+
+static PeriodicJob xLightJobs[NUM_LIGHT_JOBS];
+
+#if (NUM_BLINKY_JOBS + NUM_LIGHT_JOBS > EDF_QUEUE_MAX_ITEMS)
+#error "More jobs than the release engine can track (EDF_QUEUE_MAX_ITEMS)"
+#endif
+
+static void prvJobMonitor(void* pvContext) {
+    (void)pvContext;
+    xLogEvent(LOG_JOBREL_SUMMARY_HEADER, (unsigned long)(NUM_BLINKY_JOBS + NUM_LIGHT_JOBS), (unsigned long)JOB_WORKER_COUNT);
+    for (UBaseType_t i = 0; i < NUM_BLINKY_JOBS; ++i) {
+        PeriodicJob* j = &xBlinkyJobs[i];
+        xLogEvent(LOG_JOBREL_SUMMARY_JOB, j->name, (unsigned long)j->releases, (unsigned long)j->completions, (unsigned long)j->overruns);
+    }
+    uint32_t ulReleases = 0, ulOverruns = 0;
+    for (UBaseType_t i = 0; i < NUM_LIGHT_JOBS; ++i) {
+        ulReleases += xLightJobs[i].releases;
+        ulOverruns += xLightJobs[i].overruns;
+    }
+    xLogEvent(LOG_JOBREL_SUMMARY_LIGHT, (unsigned long)NUM_LIGHT_JOBS, (unsigned long)ulReleases,
+        (unsigned long)ulOverruns, (unsigned long)ulJobReleaseDropped());
+    vLogRequestFlush(); // print the summary in one go
+}
+
+void main_job_release_demo(void) {
+    vJobReleaseInit();
+
+    for (UBaseType_t i = 0; i < NUM_BLINKY_JOBS; ++i) {
+        xJobReleaseAdd(&xBlinkyJobs[i]);
+    }
+    // periods 50..500 ms in 50 ms steps, phases staggered so releases do not all coincide
+    for (UBaseType_t i = 0; i < NUM_LIGHT_JOBS; ++i) {
+        PeriodicJob* j = &xLightJobs[i];
+        j->name = "Light";
+        j->pxFunction = prvLightJob;
+        j->pvContext = (void*)(uintptr_t)i;
+        j->period = pdMS_TO_TICKS(50 * (1 + i % 10));
+        j->phase = (TickType_t)(i % 7);
+        xJobReleaseAdd(j);
+    }
+
+    vJobReleaseStart();
+    vLogInit();
+    vTaskStartScheduler();
+}
+
+/* ----------------------------
+   14) Replay Benchmark
+   ---------------------------- */
+
+   /* Runs one BenchCase (bench.c) through prvEDF_Setup() or prvFT_Setup() with every task
+      drawing its jobs from its own seeded stream, then prints the metrics and exits.
+      The log drain is not started, so there is no console I/O during the run; the demo
+      tasks' log records are simply dropped once the ring is full.
+      Partitioned EDF (FREERTOS_BENCH_CORES > 1): the case is packed onto the processors and
+      only this process's partition is set up. Its tasks keep the job streams of their
+      position in the case, so they replay the same jobs as in any other packing.
+   */
+
+static const BenchCase* pxBenchCase = NULL;
+static uint32_t ulBenchRunSeed = 0;
+static UBaseType_t uxBenchRunCount = 0;  // tasks set up by this process
+static BenchPartition xBenchPartition;
+static BenchPartition* pxBenchPartition = NULL; // NULL unless partitioned
+
+/* Pack the EDF case onto pxPartition->cores processors and keep, at the front of pxDefs and
+   pxModels, only the tasks of pxPartition->partition. Returns how many that are. */
+static UBaseType_t prvEDF_Partition(EDFTaskDef* pxDefs, BenchJobModel* pxModels, UBaseType_t uxCount,
+    BenchPartition* pxPartition) {
+    static EDFTaskSpec xSpecs[BENCH_MAX_TASKS];
+    static EDFPartitionPlan xPlan;
+    UBaseType_t uxMembers[EDF_PARTITION_MAX_TASKS];
+    configASSERT(pxPartition->cores <= EDF_PARTITION_MAX && pxPartition->partition < pxPartition->cores);
+
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        xSpecs[i].name = pxDefs[i].name;
+        xSpecs[i].period = pdMS_TO_TICKS(pxDefs[i].periodMs);
+        xSpecs[i].deadline = pdMS_TO_TICKS(pxDefs[i].deadlineMs);
+        xSpecs[i].wcet = pdMS_TO_TICKS(pxDefs[i].wcetMs);
+    }
+    (void)xEDFPartitionFirstFitDecreasing(xSpecs, uxCount, pxPartition->cores, &xPlan);
+    vEDFPartitionPrint(pxBenchCase->name, xSpecs, uxCount, &xPlan);
+
+    // members come in input order, so compacting in place never overwrites one still to move
+    UBaseType_t uxMine = uxEDFPartitionMembers(&xPlan, uxCount, pxPartition->partition, uxMembers);
+    for (UBaseType_t k = 0; k < uxMine; ++k) {
+        pxDefs[k] = pxDefs[uxMembers[k]];
+        pxModels[k] = pxModels[uxMembers[k]];
+    }
+    pxPartition->utilisationPpm = xPlan.utilisationPpm[pxPartition->partition];
+    pxPartition->unassigned = xPlan.unassigned;
+    return uxMine;
+}
+
+static void vBenchReporter(void* pvParameters) {
+    (void)pvParameters;
+    static BenchTaskResult xResults[BENCH_MAX_TASKS];
+    UBaseType_t uxCount = uxBenchRunCount;
 
-    // create two workers: pass the bit mask (1<<0 and 1<<1) via pvParameters
-    xTaskCreate(vWorkerTask, "Worker1", configMINIMAL_STACK_SIZE + 20, (void*)(uintptr_t)(1UL << 0), 2, &xWorker1);
-    xTaskCreate(vWorkerTask, "Worker2", configMINIMAL_STACK_SIZE + 20, (void*)(uintptr_t)(1UL << 1), 2, &xWorker2);
+    vTaskDelay(pdMS_TO_TICKS(pxBenchCase->durationMs));
+
+    vTaskSuspendAll();
+    for (UBaseType_t i = 0; i < uxCount; ++i) {
+        BenchTaskResult* r = &xResults[i];
+        if (pxBenchCase->policy == BENCH_POLICY_EDF) {
+            r->name = edfTasks[i].name;
+            r->jobs = edfTasks[i].stats.jobs;
+            r->deadlineMisses = edfTasks[i].deadlineMisses;
+            r->backupActivations = 0;
+            r->stats = &edfTasks[i].stats;
+        }
+        else {
+            FTStatsSnapshot xSnapshot;
+            // a writer this task preempted mid-update stays there: the copy may then be one job off
+            (void)prvFT_Snapshot(&ftTasks[i], &xSnapshot);
+            r->name = ftTasks[i].name;
+            r->jobs = ftTasks[i].stats.jobs;
+            r->deadlineMisses = xSnapshot.deadlineMisses;
+            r->backupActivations = xSnapshot.backupActivations;
+            r->stats = &ftTasks[i].stats;
+        }
+    }
+    vBenchPrintResults(pxBenchCase, ulBenchRunSeed, pxBenchPartition,
+        (pxBenchCase->policy == BENCH_POLICY_EDF) ? &xEDFSchedulerCost : NULL, xResults, uxCount);
+    exit(0);
+}
+
+void main_benchmark(void) {
+    static BenchJobModel xModels[BENCH_MAX_TASKS];
+    BaseType_t xSetUp;
+
+    pxBenchCase = pxBenchSelectCase();
+    ulBenchRunSeed = ulBenchSeed(pxBenchCase);
+    uxBenchRunCount = pxBenchCase->count;
+    configASSERT(pxBenchCase->count <= BENCH_MAX_TASKS);
+
+    for (UBaseType_t i = 0; i < pxBenchCase->count; ++i) {
+        vBenchModelInit(&xModels[i], &pxBenchCase->tasks[i], ulBenchRunSeed, (uint32_t)i);
+    }
+
+    // declared budgets are the largest normal execution; overruns are the faults being measured.
+    // FT jobs are all HI criticality, so a mode switch sheds nothing and the results stay
+    // comparable with runs before mixed criticality.
+    if (pxBenchCase->policy == BENCH_POLICY_EDF) {
+        static EDFTaskDef xDefs[BENCH_MAX_TASKS];
+        for (UBaseType_t i = 0; i < pxBenchCase->count; ++i) {
+            const BenchTaskSpec* t = &pxBenchCase->tasks[i];
+            xDefs[i] = (EDFTaskDef){ t->name, t->periodMs, t->deadlineMs, (t->execMaxUs + 999) / 1000 };
+        }
+        if (uxBenchCores() > 1) {
+            xBenchPartition.cores = uxBenchCores();
+            xBenchPartition.partition = uxBenchPartition();
+            pxBenchPartition = &xBenchPartition;
+            uxBenchRunCount = prvEDF_Partition(xDefs, xModels, uxBenchRunCount, pxBenchPartition);
+        }
+        xSetUp = prvEDF_Setup(xDefs, uxBenchRunCount, xModels, NULL);
+    }
+    else {
+        static FTTaskDef xDefs[BENCH_MAX_TASKS];
+        if (uxBenchCores() > 1) {
+            printf("FREERTOS_BENCH_CORES only partitions EDF cases; \"%s\" runs on one processor\r\n", pxBenchCase->name);
+        }
+        for (UBaseType_t i = 0; i < pxBenchCase->count; ++i) {
+            const BenchTaskSpec* t = &pxBenchCase->tasks[i];
+            uint32_t ulBudgetMs = (t->execMaxUs + 999) / 1000;
+            xDefs[i] = (FTTaskDef){ t->name, t->periodMs, t->deadlineMs, FT_CRIT_HI, ulBudgetMs, ulBudgetMs,
+                (t->backupExecUs + 999) / 1000, t->overrunPermille };
+        }
+        xSetUp = prvFT_Setup(xDefs, pxBenchCase->count, xModels, ulBenchRunSeed);
+    }
+    if (xSetUp == pdFAIL) {
+        return;
+    }
 
+    prvCreateAuditedTask(vBenchReporter, "BenchReport", configMINIMAL_STACK_SIZE + 60, NULL, configMAX_PRIORITIES - 1);
     vTaskStartScheduler();
 }
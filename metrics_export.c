@@ -0,0 +1,254 @@
+/* metrics_export.c
+   Snapshot builder and scrape thread of the metrics endpoint (see metrics_export.h).
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <windows.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "metrics_export.h"
+#include "service_loop.h"
+#include "heap_stats.h"
+#include "block_pool.h"
+
+#if defined(_MSC_VER)
+#pragma comment(lib, "wsock32.lib")
+#endif
+
+#define METRICS_TRAILER_BYTES 128 // kept free for the exporter's own last family
+#define METRICS_HEADER_BYTES 160
+
+static char cText[2][METRICS_TEXT_BYTES];
+static volatile size_t xTextLength[2];
+static volatile LONG lPublished = -1;      // half the thread may serve, -1 before the first snapshot
+static volatile uint32_t ulGeneration = 0; // bumped after each publish, before the next build
+static uint32_t ulTruncated = 0;           // snapshots that did not fit
+static MetricsSource_t pxSources[METRICS_MAX_SOURCES];
+static UBaseType_t uxSources = 0;
+static TaskStatus_t xStatus[METRICS_MAX_TASKS];
+static SOCKET xListenSocket = INVALID_SOCKET;
+static char cServe[METRICS_TEXT_BYTES]; // the thread's copy, too big for its stack
+
+static const char* const pcFaultNames[SERVICE_FAULT_COUNT] = {
+    "overrun", "backup", "deadline_miss", "heartbeat", "restart"
+};
+
+void vMetricsTextAppend(MetricsText* pxText, const char* pcFormat, ...) {
+    size_t xLeft = pxText->size - pxText->used;
+    va_list args;
+    va_start(args, pcFormat);
+    int iWritten = vsnprintf(pxText->buffer + pxText->used, xLeft, pcFormat, args);
+    va_end(args);
+    if (iWritten < 0 || (size_t)iWritten >= xLeft) {
+        pxText->buffer[pxText->used] = '\0'; // drop the partial line
+        pxText->truncated = pdTRUE;
+        return;
+    }
+    pxText->used += (size_t)iWritten;
+}
+
+static void prvAppendTasks(MetricsText* t) {
+    configRUN_TIME_COUNTER_TYPE ulTotal = 0;
+    UBaseType_t uxTasks = uxTaskGetSystemState(xStatus, METRICS_MAX_TASKS, &ulTotal);
+
+    vMetricsTextAppend(t, "# TYPE freertos_uptime_us gauge\nfreertos_uptime_us %llu\n",
+        (unsigned long long)ulTotal);
+    vMetricsTextAppend(t, "# TYPE freertos_tasks gauge\nfreertos_tasks %lu\n",
+        (unsigned long)uxTaskGetNumberOfTasks());
+    vMetricsTextAppend(t, "# TYPE freertos_task_run_time_us_total counter\n");
+    for (UBaseType_t i = 0; i < uxTasks; ++i) {
+        vMetricsTextAppend(t, "freertos_task_run_time_us_total{task=\"%s\"} %llu\n",
+            xStatus[i].pcTaskName, (unsigned long long)xStatus[i].ulRunTimeCounter);
+    }
+    vMetricsTextAppend(t, "# TYPE freertos_task_stack_free_words gauge\n");
+    for (UBaseType_t i = 0; i < uxTasks; ++i) {
+        vMetricsTextAppend(t, "freertos_task_stack_free_words{task=\"%s\"} %lu\n",
+            xStatus[i].pcTaskName, (unsigned long)xStatus[i].usStackHighWaterMark);
+    }
+}
+
+static void prvAppendHeap(MetricsText* t) {
+    static const struct {
+        const char* name;
+        const char* type;
+    } xFamilies[] = {
+        { "freertos_heap_free_bytes", "gauge" },
+        { "freertos_heap_min_free_bytes", "gauge" },
+        { "freertos_heap_largest_free_block_bytes", "gauge" },
+        { "freertos_heap_fragmentation_permille", "gauge" },
+        { "freertos_heap_allocations_total", "counter" },
+        { "freertos_heap_frees_total", "counter" },
+    };
+    HeapRegionStats xRegions[HEAP_STATS_MAX_REGIONS];
+    UBaseType_t uxRegions = uxHeapStatsRegionCount();
+
+    // one query per region, then one family at a time
+    for (UBaseType_t r = 0; r < uxRegions; ++r) {
+        (void)xHeapStatsGetRegion(r, &xRegions[r]);
+    }
+    for (UBaseType_t f = 0; f < sizeof(xFamilies) / sizeof(xFamilies[0]); ++f) {
+        vMetricsTextAppend(t, "# TYPE %s %s\n", xFamilies[f].name, xFamilies[f].type);
+        for (UBaseType_t r = 0; r < uxRegions; ++r) {
+            const HeapRegionStats* s = &xRegions[r];
+            const size_t xValues[] = { s->freeBytes, s->minimumEverFreeBytes, s->largestFreeBlock,
+                s->fragmentationPermille, s->allocations, s->frees };
+            vMetricsTextAppend(t, "%s{region=\"%lu\"} %lu\n", xFamilies[f].name, (unsigned long)r,
+                (unsigned long)xValues[f]);
+        }
+    }
+    vMetricsTextAppend(t, "# TYPE freertos_heap_failed_allocations_total counter\nfreertos_heap_failed_allocations_total %lu\n",
+        (unsigned long)ulHeapStatsFailedAllocations());
+}
+
+static void prvAppendBlockPools(MetricsText* t) {
+    vMetricsTextAppend(t, "# TYPE freertos_block_pool_free_blocks gauge\n");
+    for (UBaseType_t c = 0; c < BLOCK_POOL_CLASS_COUNT; ++c) {
+        vMetricsTextAppend(t, "freertos_block_pool_free_blocks{class=\"%lu\"} %lu\n", (unsigned long)c,
+            (unsigned long)uxBlockPoolFreeBlocks((BlockPoolClass)c));
+    }
+    vMetricsTextAppend(t, "# TYPE freertos_block_pool_min_free_blocks gauge\n");
+    for (UBaseType_t c = 0; c < BLOCK_POOL_CLASS_COUNT; ++c) {
+        vMetricsTextAppend(t, "freertos_block_pool_min_free_blocks{class=\"%lu\"} %lu\n", (unsigned long)c,
+            (unsigned long)uxBlockPoolMinimumEverFreeBlocks((BlockPoolClass)c));
+    }
+    vMetricsTextAppend(t, "# TYPE freertos_block_pool_heap_fallbacks_total counter\nfreertos_block_pool_heap_fallbacks_total %lu\n",
+        (unsigned long)ulBlockPoolHeapFallbacks());
+}
+
+static void prvAppendFaults(MetricsText* t) {
+    vMetricsTextAppend(t, "# TYPE demo_faults_total counter\n");
+    for (UBaseType_t i = 0; i < SERVICE_FAULT_COUNT; ++i) {
+        vMetricsTextAppend(t, "demo_faults_total{type=\"%s\"} %lu\n", pcFaultNames[i],
+            (unsigned long)ulServiceLoopFaults((ServiceFaultType)i));
+    }
+}
+
+/* Service timer: build the next snapshot in the half the thread is not serving. */
+static void prvSnapshot(void* pvContext) {
+    LONG lBack = (lPublished == 0) ? 1 : 0;
+    MetricsText xText = { cText[lBack], METRICS_TEXT_BYTES - METRICS_TRAILER_BYTES, 0, pdFALSE };
+    (void)pvContext;
+
+    xText.buffer[0] = '\0';
+    prvAppendTasks(&xText);
+    prvAppendHeap(&xText);
+    prvAppendBlockPools(&xText);
+    prvAppendFaults(&xText);
+    for (UBaseType_t i = 0; i < uxSources; ++i) {
+        pxSources[i](&xText);
+    }
+    if (xText.truncated != pdFALSE) {
+        ulTruncated++;
+    }
+    xText.size = METRICS_TEXT_BYTES;
+    vMetricsTextAppend(&xText, "# TYPE metrics_export_truncated_total counter\nmetrics_export_truncated_total %lu\n",
+        (unsigned long)ulTruncated);
+
+    xTextLength[lBack] = xText.used;
+    MemoryBarrier(); // the text is complete before the thread can pick this half
+    lPublished = lBack;
+    MemoryBarrier();
+    ulGeneration++; // from here on the other half may be overwritten
+}
+
+/* Copy the published text into cServe. Returns its length, 0 before the first snapshot. */
+static size_t prvCopyPublished(void) {
+    for (;;) {
+        uint32_t ulBefore = ulGeneration;
+        MemoryBarrier();
+        LONG lHalf = lPublished;
+        if (lHalf < 0) {
+            return 0;
+        }
+        size_t xLength = xTextLength[lHalf];
+        memcpy(cServe, cText[lHalf], xLength);
+        MemoryBarrier();
+        if (ulGeneration == ulBefore) {
+            return xLength;
+        }
+        // a newer snapshot came out, and the builder may have started on this half again
+    }
+}
+
+static void prvSendAll(SOCKET xSocket, const char* pcData, size_t xLength) {
+    while (xLength > 0) {
+        int iSent = send(xSocket, pcData, (int)xLength, 0);
+        if (iSent == SOCKET_ERROR || iSent == 0) {
+            return;
+        }
+        pcData += iSent;
+        xLength -= (size_t)iSent;
+    }
+}
+
+static DWORD WINAPI prvMetricsThread(void* pvParam) {
+    (void)pvParam;
+
+    for (;;) {
+        char cRequest[512];
+        char cHeader[METRICS_HEADER_BYTES];
+        SOCKET xClient = accept(xListenSocket, NULL, NULL);
+        if (xClient == INVALID_SOCKET) {
+            Sleep(100);
+            continue;
+        }
+
+        // whatever was asked for, the answer is the metrics
+        (void)recv(xClient, cRequest, sizeof(cRequest), 0);
+        size_t xLength = prvCopyPublished();
+        int iHeader = snprintf(cHeader, sizeof(cHeader),
+            "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n",
+            (unsigned long)xLength);
+        prvSendAll(xClient, cHeader, (size_t)iHeader);
+        prvSendAll(xClient, cServe, xLength);
+        closesocket(xClient);
+    }
+
+    /* Should not get here so return negative exit status. */
+    return (DWORD)-1;
+}
+
+BaseType_t xMetricsExportStart(void) {
+    WSADATA xWSAData;
+    struct sockaddr_in xAddress;
+    HANDLE xThread;
+
+    if (WSAStartup(MAKEWORD(1, 1), &xWSAData) != 0) {
+        return pdFAIL;
+    }
+    xListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (xListenSocket == INVALID_SOCKET) {
+        return pdFAIL;
+    }
+    memset(&xAddress, 0, sizeof(xAddress));
+    xAddress.sin_family = AF_INET;
+    xAddress.sin_port = htons(METRICS_EXPORT_PORT);
+    xAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // local scrapers only
+    if (bind(xListenSocket, (struct sockaddr*)&xAddress, sizeof(xAddress)) == SOCKET_ERROR
+        || listen(xListenSocket, 4) == SOCKET_ERROR) {
+        closesocket(xListenSocket);
+        xListenSocket = INVALID_SOCKET;
+        return pdFAIL;
+    }
+
+    xThread = CreateThread(NULL, 0, prvMetricsThread, NULL, 0, NULL);
+    if (xThread == NULL) {
+        return pdFAIL;
+    }
+
+    /* Like the keyboard thread: keep off the core the FreeRTOS threads run on. */
+    SetThreadAffinityMask(xThread, ~0x01u);
+    SetThreadPriority(xThread, THREAD_PRIORITY_BELOW_NORMAL);
+
+    return xServiceLoopAddTimer("Metrics", METRICS_SNAPSHOT_MS, prvSnapshot, NULL);
+}
+
+BaseType_t xMetricsExportAddSource(MetricsSource_t pxSource) {
+    if (uxSources >= METRICS_MAX_SOURCES) {
+        return pdFAIL;
+    }
+    pxSources[uxSources++] = pxSource;
+    return pdPASS;
+}
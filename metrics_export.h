@@ -0,0 +1,52 @@
+/* metrics_export.h
+   Prometheus text exposition of the demo's figures over TCP (Win32 simulator only).
+   - every METRICS_SNAPSHOT_MS a service timer (service_loop.h) reads everything in one
+     batch and formats it into the back half of a double buffer, then publishes that half:
+     per-task run time and stack headroom (uxTaskGetSystemState()), heap_5 region figures
+     (heap_stats.h), task pool occupancy and heap fallbacks (block_pool.h), fault totals of
+     the service loop, plus whatever the registered sources add (the demos' per-task
+     deadline misses, backup activations, restarts, ...)
+   - a Windows thread outside the scheduler, on the cores the FreeRTOS threads do not use,
+     answers every connection to 127.0.0.1:METRICS_EXPORT_PORT with an HTTP/1.0 response
+     holding the last published text; it never calls into FreeRTOS, so a scrape costs the
+     real-time tasks nothing but the snapshot they already pay for once a period
+   - the thread copies the published half and keeps the copy only if no newer snapshot was
+     published meanwhile (the builder may have started on that half again)
+   A source writes whole metric families: its "# TYPE" line, then all samples of that
+   metric. Text past METRICS_TEXT_BYTES is cut off at a line boundary and counted.
+*/
+
+#ifndef METRICS_EXPORT_H
+#define METRICS_EXPORT_H
+
+#include "FreeRTOS.h"
+#include <stddef.h>
+
+#define METRICS_EXPORT_PORT 9464
+#define METRICS_SNAPSHOT_MS 1000
+#define METRICS_MAX_TASKS 224 // as STACK_AUDIT_MAX_TASKS: uxTaskGetSystemState() needs room for all
+#define METRICS_MAX_SOURCES 4
+#define METRICS_TEXT_BYTES 65536 // two per-task families of the largest EDF set fit
+
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t used;
+    BaseType_t truncated;
+} MetricsText;
+
+typedef void (*MetricsSource_t)(MetricsText* pxText);
+
+/* Open the listening socket, start the serving thread and the snapshot timer. Call after
+   vServiceLoopInit() and before vTaskStartScheduler(). Returns pdFAIL if the socket or the
+   thread could not be created. */
+BaseType_t xMetricsExportStart(void);
+
+/* Have pxSource append its families to every snapshot. Call before vTaskStartScheduler().
+   Returns pdFAIL when all METRICS_MAX_SOURCES are taken. */
+BaseType_t xMetricsExportAddSource(MetricsSource_t pxSource);
+
+/* printf-style append of one or more whole lines. */
+void vMetricsTextAppend(MetricsText* pxText, const char* pcFormat, ...);
+
+#endif /* METRICS_EXPORT_H */
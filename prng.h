@@ -0,0 +1,46 @@
+/* prng.h
+   Small seeded pseudo-random generator for fault injection and the replay benchmark.
+   - xorshift32: one 32-bit word of state per stream, no locks, no library calls, so every
+     task can own a stream and the sequence it sees does not depend on how tasks interleave
+   - vPrngSeed() runs the seed and a stream number (e.g. the task index) through splitmix32,
+     so streams from the same seed are independent and never get the all-zero state
+*/
+
+#ifndef PRNG_H
+#define PRNG_H
+
+#include "FreeRTOS.h"
+
+typedef struct {
+    uint32_t state;
+} Prng;
+
+static inline void vPrngSeed(Prng* p, uint32_t ulSeed, uint32_t ulStream) {
+    uint32_t z = ulSeed + ulStream * 0x9E3779B9u;
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    z ^= z >> 16;
+    p->state = (z != 0) ? z : 0x6D2B79F5u;
+}
+
+static inline uint32_t ulPrngNext(Prng* p) {
+    uint32_t x = p->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p->state = x;
+    return x;
+}
+
+/* Uniform in [ulLow, ulHigh] (multiply-shift, no division). */
+static inline uint32_t ulPrngRange(Prng* p, uint32_t ulLow, uint32_t ulHigh) {
+    uint64_t ullSpan = (uint64_t)(ulHigh - ulLow) + 1;
+    return ulLow + (uint32_t)(((uint64_t)ulPrngNext(p) * ullSpan) >> 32);
+}
+
+/* pdTRUE with probability ulPermille / 1000. */
+static inline BaseType_t xPrngChance(Prng* p, uint32_t ulPermille) {
+    return (ulPrngRange(p, 0, 999) < ulPermille) ? pdTRUE : pdFALSE;
+}
+
+#endif /* PRNG_H */
@@ -0,0 +1,46 @@
+/* seq_stats.c
+   Seqlock writer and reader (see seq_stats.h).
+*/
+
+#include <windows.h>
+#include "FreeRTOS.h"
+#include "seq_stats.h"
+
+void vSeqStatsInit(SeqStats* s) {
+    s->sequence = 0;
+    for (UBaseType_t i = 0; i < SEQ_STATS_MAX_COUNTERS; ++i) {
+        s->value[i] = 0;
+    }
+}
+
+void vSeqStatsWriteBegin(SeqStats* s) {
+    s->sequence++;
+    MemoryBarrier(); // the odd sequence is visible before any counter changes
+}
+
+void vSeqStatsWriteEnd(SeqStats* s) {
+    MemoryBarrier(); // every counter change is visible before the sequence turns even
+    s->sequence++;
+}
+
+void vSeqStatsAdd(SeqStats* s, UBaseType_t uxCounter, uint32_t ulDelta) {
+    configASSERT(uxCounter < SEQ_STATS_MAX_COUNTERS);
+    vSeqStatsWriteBegin(s);
+    s->value[uxCounter] += ulDelta;
+    vSeqStatsWriteEnd(s);
+}
+
+BaseType_t xSeqStatsRead(const SeqStats* s, uint32_t* pulValues) {
+    for (UBaseType_t uxTry = 0; uxTry < SEQ_STATS_READ_TRIES; ++uxTry) {
+        uint32_t ulBefore = s->sequence;
+        MemoryBarrier();
+        for (UBaseType_t i = 0; i < SEQ_STATS_MAX_COUNTERS; ++i) {
+            pulValues[i] = s->value[i];
+        }
+        MemoryBarrier();
+        if ((ulBefore & 1u) == 0 && s->sequence == ulBefore) {
+            return pdPASS;
+        }
+    }
+    return pdFAIL;
+}
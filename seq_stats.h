@@ -0,0 +1,41 @@
+/* seq_stats.h
+   Single-writer statistics counters with seqlock snapshots.
+   - a SeqStats block holds up to SEQ_STATS_MAX_COUNTERS counters and has exactly one writer
+     (a task or the tick hook); counters with different writers go into different blocks
+   - the writer brackets an update with vSeqStatsWriteBegin()/vSeqStatsWriteEnd(), which
+     make the sequence odd and then even again; no lock, no critical section, no kernel call
+   - a reader copies the block and keeps the copy only if the sequence was even and unchanged
+     across it, so several counters are always seen from the same update
+   - readers never block the writer; readers may be tasks or Windows threads
+   On the Win32 port the tasks are real threads, so both sides use full memory barriers.
+*/
+
+#ifndef SEQ_STATS_H
+#define SEQ_STATS_H
+
+#include "FreeRTOS.h"
+
+#define SEQ_STATS_MAX_COUNTERS 4
+#define SEQ_STATS_READ_TRIES 64
+
+typedef struct {
+    volatile uint32_t sequence; // odd while an update is in progress
+    volatile uint32_t value[SEQ_STATS_MAX_COUNTERS];
+} SeqStats;
+
+void vSeqStatsInit(SeqStats* s);
+
+/* Writer side. Between Begin and End the writer may change any s->value[]. */
+void vSeqStatsWriteBegin(SeqStats* s);
+void vSeqStatsWriteEnd(SeqStats* s);
+
+/* Begin, s->value[uxCounter] += ulDelta, End. */
+void vSeqStatsAdd(SeqStats* s, UBaseType_t uxCounter, uint32_t ulDelta);
+
+/* Copy all counters into pulValues (SEQ_STATS_MAX_COUNTERS entries). Returns pdFAIL if no
+   consistent copy was seen in SEQ_STATS_READ_TRIES attempts - the writer stalled mid-update,
+   as it can when the reader outranks it - and pulValues then holds the last, possibly
+   torn, copy. */
+BaseType_t xSeqStatsRead(const SeqStats* s, uint32_t* pulValues);
+
+#endif /* SEQ_STATS_H */
@@ -0,0 +1,120 @@
+/* service_loop.c
+   Queue-set event loop of the service task (see service_loop.h).
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "service_loop.h"
+#include "deferred_log.h"
+#include "stack_audit.h"
+
+typedef struct {
+    ServiceFaultType type;
+    const char* source;
+    uint32_t value;
+    TickType_t tick;
+} ServiceFault;
+
+typedef struct {
+    TimerHandle_t timer;
+    StaticTimer_t timerBuffer;
+    SemaphoreHandle_t due; // given by the timer, taken by the service task
+    StaticSemaphore_t dueBuffer;
+    ServiceFunction_t function;
+    void* context;
+} ServiceTimer;
+
+static QueueSetHandle_t xServiceSet = NULL;
+static QueueHandle_t xFaultQueue = NULL;
+static StaticQueue_t xFaultQueueBuffer;
+static uint8_t ucFaultQueueStorage[SERVICE_LOOP_FAULT_QUEUE_LENGTH * sizeof(ServiceFault)];
+static ServiceTimer xTimers[SERVICE_LOOP_MAX_TIMERS];
+static UBaseType_t uxTimers = 0;
+static uint32_t ulFaults[SERVICE_FAULT_COUNT]; // only written by the service task
+static volatile uint32_t ulFaultsDropped = 0;
+
+static void prvTimerCallback(TimerHandle_t xTimer) {
+    ServiceTimer* t = (ServiceTimer*)pvTimerGetTimerID(xTimer);
+    (void)xSemaphoreGive(t->due); // fails if still due: one run covers both periods
+}
+
+static void vServiceLoopTask(void* pvParameters) {
+    (void)pvParameters;
+    for (;;) {
+        // one handle per item posted to a member, so exactly one read per wake
+        QueueSetMemberHandle_t xMember = xQueueSelectFromSet(xServiceSet, portMAX_DELAY);
+
+        if (xMember == xFaultQueue) {
+            ServiceFault xFault;
+            if (xQueueReceive(xFaultQueue, &xFault, 0) == pdPASS && xFault.type < SERVICE_FAULT_COUNT) {
+                ulFaults[xFault.type]++;
+            }
+            continue;
+        }
+
+        for (UBaseType_t i = 0; i < uxTimers; ++i) {
+            ServiceTimer* t = &xTimers[i];
+            if (xMember == (QueueSetMemberHandle_t)t->due && xSemaphoreTake(t->due, 0) == pdPASS) {
+                t->function(t->context);
+                break;
+            }
+        }
+    }
+}
+
+void vServiceLoopInit(void) {
+    // every timer semaphore can hold one item, on top of a full fault queue
+    xServiceSet = xQueueCreateSet(SERVICE_LOOP_FAULT_QUEUE_LENGTH + SERVICE_LOOP_MAX_TIMERS);
+    configASSERT(xServiceSet != NULL);
+    xFaultQueue = xQueueCreateStatic(SERVICE_LOOP_FAULT_QUEUE_LENGTH, sizeof(ServiceFault), ucFaultQueueStorage, &xFaultQueueBuffer);
+    xQueueAddToSet(xFaultQueue, xServiceSet);
+
+    TaskHandle_t xTask = NULL;
+    xTaskCreate(vServiceLoopTask, "Service", SERVICE_LOOP_STACK_SIZE, NULL, SERVICE_LOOP_PRIORITY, &xTask);
+    configASSERT(xTask != NULL);
+    vStackAuditRegister(xTask, SERVICE_LOOP_STACK_SIZE);
+}
+
+BaseType_t xServiceLoopAddTimer(const char* pcName, uint32_t ulPeriodMs, ServiceFunction_t pxFunction, void* pvContext) {
+    configASSERT(xServiceSet != NULL);
+    if (uxTimers >= SERVICE_LOOP_MAX_TIMERS) {
+        return pdFAIL;
+    }
+    ServiceTimer* t = &xTimers[uxTimers];
+    t->function = pxFunction;
+    t->context = pvContext;
+    t->due = xSemaphoreCreateBinaryStatic(&t->dueBuffer);
+    xQueueAddToSet(t->due, xServiceSet); // still empty, as a set member must be
+    t->timer = xTimerCreateStatic(pcName, pdMS_TO_TICKS(ulPeriodMs), pdTRUE, t, prvTimerCallback, &t->timerBuffer);
+    uxTimers++;
+    return xTimerStart(t->timer, 0);
+}
+
+BaseType_t xServiceLoopPostFault(ServiceFaultType xType, const char* pcSource, uint32_t ulValue) {
+    if (xFaultQueue == NULL) {
+        return pdFAIL;
+    }
+    ServiceFault xFault = { xType, pcSource, ulValue, xTaskGetTickCount() };
+    if (xQueueSend(xFaultQueue, &xFault, 0) != pdPASS) {
+        ulFaultsDropped++;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+uint32_t ulServiceLoopFaults(ServiceFaultType xType) {
+    return (xType < SERVICE_FAULT_COUNT) ? ulFaults[xType] : 0;
+}
+
+void vServiceLoopReportFaults(void) {
+    xLogEvent(LOG_SERVICE_FAULTS,
+        (unsigned long)ulFaults[SERVICE_FAULT_OVERRUN],
+        (unsigned long)ulFaults[SERVICE_FAULT_BACKUP],
+        (unsigned long)ulFaults[SERVICE_FAULT_DEADLINE_MISS],
+        (unsigned long)ulFaults[SERVICE_FAULT_HEARTBEAT],
+        (unsigned long)ulFaults[SERVICE_FAULT_RESTART],
+        (unsigned long)ulFaultsDropped);
+}
@@ -0,0 +1,51 @@
+/* service_loop.h
+   One service task for the demos' bookkeeping, blocked on a single queue set.
+   - members: a queue of fault events (overruns, backup activations, deadline misses, missed
+     heartbeats and restarts) and one binary semaphore per service timer
+   - a service timer is a FreeRTOS software timer whose callback only gives its semaphore;
+     the work (a periodic report, a statistics sample) runs in the service task
+   - the task sleeps in xQueueSelectFromSet() until a fault arrives or a timer is due, so
+     nothing polls, and the monitors and the stack audit share one stack
+   - faults are counted per type; posting never blocks, a full queue counts a drop
+*/
+
+#ifndef SERVICE_LOOP_H
+#define SERVICE_LOOP_H
+
+#include "FreeRTOS.h"
+
+#define SERVICE_LOOP_MAX_TIMERS 4
+#define SERVICE_LOOP_FAULT_QUEUE_LENGTH 16
+#define SERVICE_LOOP_PRIORITY (tskIDLE_PRIORITY + 1)
+#define SERVICE_LOOP_STACK_SIZE (configMINIMAL_STACK_SIZE + 80)
+
+typedef enum {
+    SERVICE_FAULT_OVERRUN = 0,     // a primary overran or was stopped on its budget
+    SERVICE_FAULT_BACKUP,          // a backup ran in place of its primary
+    SERVICE_FAULT_DEADLINE_MISS,
+    SERVICE_FAULT_HEARTBEAT,       // a watchdog worker missed a cycle
+    SERVICE_FAULT_RESTART,         // the supervisor restarted a worker
+    SERVICE_FAULT_COUNT
+} ServiceFaultType;
+
+typedef void (*ServiceFunction_t)(void* pvContext);
+
+/* Create the queue set, the fault queue and the service task. Call once before
+   vTaskStartScheduler(). */
+void vServiceLoopInit(void);
+
+/* Run pxFunction in the service task every ulPeriodMs. Returns pdFAIL when all
+   SERVICE_LOOP_MAX_TIMERS are taken. */
+BaseType_t xServiceLoopAddTimer(const char* pcName, uint32_t ulPeriodMs, ServiceFunction_t pxFunction, void* pvContext);
+
+/* Report a fault of pcSource (a literal or task name); ulValue is type specific. Never
+   blocks. Returns pdFAIL if the fault was dropped. */
+BaseType_t xServiceLoopPostFault(ServiceFaultType xType, const char* pcSource, uint32_t ulValue);
+
+/* Faults of xType handled so far. */
+uint32_t ulServiceLoopFaults(ServiceFaultType xType);
+
+/* Log the fault totals. */
+void vServiceLoopReportFaults(void);
+
+#endif /* SERVICE_LOOP_H */
@@ -0,0 +1,134 @@
+/* stack_audit.c
+   Periodic stack high-water-mark sampling (see stack_audit.h).
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "stack_audit.h"
+#include "deferred_log.h"
+#include "service_loop.h"
+#include <string.h>
+
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    configSTACK_DEPTH_TYPE depth;       // 0 when not registered
+    configSTACK_DEPTH_TYPE worstFree;
+    uint32_t samples;
+} StackAuditEntry;
+
+static StackAuditEntry xEntries[STACK_AUDIT_MAX_TASKS];
+static UBaseType_t uxEntries = 0;
+static TaskStatus_t xStatus[STACK_AUDIT_MAX_TASKS];
+static uint32_t ulOverflowedSamples = 0; // samples skipped because of too many tasks
+
+/* Find the entry of xTask, adding one if there is room. */
+static StackAuditEntry* prvEntry(TaskHandle_t xTask) {
+    StackAuditEntry* e = NULL;
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < uxEntries; ++i) {
+        if (xEntries[i].handle == xTask) {
+            e = &xEntries[i];
+            break;
+        }
+    }
+    if (e == NULL && uxEntries < STACK_AUDIT_MAX_TASKS) {
+        e = &xEntries[uxEntries++];
+        e->handle = xTask;
+        e->name[0] = '\0';
+        e->depth = 0;
+        e->worstFree = (configSTACK_DEPTH_TYPE)~(configSTACK_DEPTH_TYPE)0;
+        e->samples = 0;
+    }
+    taskEXIT_CRITICAL();
+    return e;
+}
+
+void vStackAuditRegister(TaskHandle_t xTask, configSTACK_DEPTH_TYPE uxDepth) {
+    StackAuditEntry* e = (xTask != NULL) ? prvEntry(xTask) : NULL;
+    if (e != NULL) {
+        e->depth = uxDepth;
+    }
+}
+
+static void prvSample(void) {
+    UBaseType_t uxTasks = uxTaskGetSystemState(xStatus, STACK_AUDIT_MAX_TASKS, NULL);
+    if (uxTasks == 0) {
+        ulOverflowedSamples++;
+        return;
+    }
+    for (UBaseType_t i = 0; i < uxTasks; ++i) {
+        StackAuditEntry* e = prvEntry(xStatus[i].xHandle);
+        if (e == NULL) {
+            continue;
+        }
+        // a different task now lives at this handle (freed and reused TCB): start over
+        if (e->samples != 0 && strncmp(e->name, xStatus[i].pcTaskName, configMAX_TASK_NAME_LEN) != 0) {
+            e->worstFree = (configSTACK_DEPTH_TYPE)~(configSTACK_DEPTH_TYPE)0;
+            e->samples = 0;
+        }
+        if (e->samples == 0) {
+            strncpy(e->name, xStatus[i].pcTaskName, configMAX_TASK_NAME_LEN - 1);
+            e->name[configMAX_TASK_NAME_LEN - 1] = '\0';
+        }
+        if (xStatus[i].usStackHighWaterMark < e->worstFree) {
+            e->worstFree = xStatus[i].usStackHighWaterMark;
+        }
+        e->samples++;
+    }
+}
+
+static uint32_t prvRecommended(const StackAuditEntry* e) {
+    uint32_t ulUsed = (e->worstFree < e->depth) ? (uint32_t)(e->depth - e->worstFree) : 0;
+    uint32_t ulMargin = ulUsed * STACK_AUDIT_MARGIN_PERCENT / 100;
+    if (ulMargin < STACK_AUDIT_MIN_MARGIN) {
+        ulMargin = STACK_AUDIT_MIN_MARGIN;
+    }
+    return (ulUsed + ulMargin + STACK_AUDIT_ROUND - 1) / STACK_AUDIT_ROUND * STACK_AUDIT_ROUND;
+}
+
+void vStackAuditReport(void) {
+    uint32_t ulReclaimable = 0;
+    xLogEvent(LOG_STACK_AUDIT_HEADER, (unsigned long)ulOverflowedSamples);
+    for (UBaseType_t i = 0; i < uxEntries; ++i) {
+        const StackAuditEntry* e = &xEntries[i];
+        if (e->samples == 0) {
+            continue;
+        }
+        if (e->depth == 0) {
+            xLogEvent(LOG_STACK_AUDIT_UNSIZED, e->name, (unsigned long)e->worstFree);
+            continue;
+        }
+        uint32_t ulRecommended = prvRecommended(e);
+        if (ulRecommended < e->depth) {
+            ulReclaimable += e->depth - ulRecommended;
+        }
+        xLogEvent(LOG_STACK_AUDIT_TASK, e->name, (unsigned long)e->depth,
+            (unsigned long)(e->depth - e->worstFree), (unsigned long)e->worstFree, (unsigned long)ulRecommended);
+    }
+    xLogEvent(LOG_STACK_AUDIT_FOOTER, (unsigned long)ulReclaimable,
+        (unsigned long)(ulReclaimable * sizeof(StackType_t)));
+}
+
+/* Service timer: one sample per STACK_AUDIT_SAMPLE_MS, in the service task. */
+static void prvAuditTick(void* pvContext) {
+    static uint32_t ulSamples = 0;
+    (void)pvContext;
+
+    if (ulSamples == 0) {
+        // the kernel's own tasks get their memory from main.c; they exist once the scheduler runs
+        vStackAuditRegister(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+        vStackAuditRegister(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+    }
+    prvSample();
+    if (++ulSamples % STACK_AUDIT_REPORT_EVERY == 0) {
+        vStackAuditReport();
+    }
+}
+
+void vStackAuditStart(void) {
+    BaseType_t xAdded = xServiceLoopAddTimer("StackAudit", STACK_AUDIT_SAMPLE_MS, prvAuditTick, NULL);
+    configASSERT(xAdded == pdPASS);
+    (void)xAdded;
+}
@@ -0,0 +1,39 @@
+/* stack_audit.h
+   Stack high-water-mark audit and stack size recommendations.
+   - a service timer (service_loop.h) samples every task once per STACK_AUDIT_SAMPLE_MS with
+     uxTaskGetSystemState(), which returns each task's high-water mark, and keeps the worst
+     (smallest) free space seen per task
+   - tasks whose depth was given to vStackAuditRegister() get a recommended depth: the words
+     actually used plus STACK_AUDIT_MARGIN_PERCENT (at least STACK_AUDIT_MIN_MARGIN words),
+     rounded up to STACK_AUDIT_ROUND words; others are reported without one
+   - every STACK_AUDIT_REPORT_EVERY samples the table is written through the deferred logger
+   Figures are in words (StackType_t), the unit xTaskCreate() takes.
+   Once the recommended sizes are in, configSTACK_SIZES_VALIDATED in FreeRTOSConfig.h turns
+   off the per-switch overflow check; the audit itself does not depend on it.
+*/
+
+#ifndef STACK_AUDIT_H
+#define STACK_AUDIT_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define STACK_AUDIT_MAX_TASKS 224 // the largest EDF set (200) plus the system and demo tasks
+#define STACK_AUDIT_SAMPLE_MS 1000
+#define STACK_AUDIT_REPORT_EVERY 10
+#define STACK_AUDIT_MARGIN_PERCENT 25
+#define STACK_AUDIT_MIN_MARGIN 16
+#define STACK_AUDIT_ROUND 8
+
+/* Record the depth xTask was created with. Calling it again for the same handle (a task
+   recreated in the same static memory) just updates the depth. */
+void vStackAuditRegister(TaskHandle_t xTask, configSTACK_DEPTH_TYPE uxDepth);
+
+/* Start sampling from the service task; vServiceLoopInit() must have run. The idle and
+   timer tasks are registered on the first sample. */
+void vStackAuditStart(void);
+
+/* Log the current table. */
+void vStackAuditReport(void);
+
+#endif /* STACK_AUDIT_H */
@@ -0,0 +1,46 @@
+/* trace_map.c
+   Trace file mapped into memory with CreateFileMapping (see trace_map.h).
+*/
+
+#include <stdint.h>
+#include <windows.h>
+#include "trace_map.h"
+
+static HANDLE xTraceFile = INVALID_HANDLE_VALUE;
+static HANDLE xTraceMapping = NULL;
+static void* pvTraceView = NULL;
+static size_t xTraceViewBytes = 0;
+
+void* pvTraceMapOpen(const char* pcFileName, size_t xBytes) {
+    xTraceFile = CreateFileA(pcFileName, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (xTraceFile == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    // mapping at the full size sets the file length; the new pages read back as zeros
+    xTraceMapping = CreateFileMappingA(xTraceFile, NULL, PAGE_READWRITE, (DWORD)((uint64_t)xBytes >> 32),
+        (DWORD)xBytes, NULL);
+    if (xTraceMapping != NULL) {
+        pvTraceView = MapViewOfFile(xTraceMapping, FILE_MAP_ALL_ACCESS, 0, 0, xBytes);
+    }
+    if (pvTraceView == NULL) {
+        if (xTraceMapping != NULL) {
+            CloseHandle(xTraceMapping);
+            xTraceMapping = NULL;
+        }
+        CloseHandle(xTraceFile);
+        xTraceFile = INVALID_HANDLE_VALUE;
+        return NULL;
+    }
+
+    xTraceViewBytes = xBytes;
+    return pvTraceView;
+}
+
+int xTraceMapFlush(void) {
+    if (pvTraceView == NULL) {
+        return 0;
+    }
+    return FlushViewOfFile(pvTraceView, xTraceViewBytes) ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+/* trace_map.h
+   Memory-mapped trace file for the Win32 simulator.
+   - the file is created at the size of RecorderDataType and mapped read/write; the recorder
+     is then given the view as its data buffer (vTraceSetRecorderDataBuffer), so every event
+     it records is already in the file's pages and a snapshot needs no copy
+   - the pages belong to the system file cache, so they reach the disk even when the process
+     dies in vAssertCalled or is killed; vTraceMapFlush() only forces the write-back early
+   Requires the recorder to be built with TRC_CFG_RECORDER_BUFFER_ALLOCATION set to
+   TRC_RECORDER_BUFFER_ALLOCATION_CUSTOM, and the view to be handed over before
+   xTraceInitialize().
+*/
+
+#ifndef TRACE_MAP_H
+#define TRACE_MAP_H
+
+#include <stddef.h>
+
+/* Create pcFileName at xBytes and map it. Returns the view, or NULL on failure. */
+void* pvTraceMapOpen(const char* pcFileName, size_t xBytes);
+
+/* Write the dirty pages of the view back to the file. Returns 0 on failure. */
+int xTraceMapFlush(void);
+
+#endif /* TRACE_MAP_H */
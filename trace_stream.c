@@ -0,0 +1,127 @@
+/* trace_stream.c
+   Drains the snapshot recorder's event ring from a Windows thread (see trace_stream.h).
+   Only Windows and C library calls are made on that thread; it never calls into FreeRTOS.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <windows.h>
+#include "FreeRTOS.h"
+#include "trcRecorder.h"
+#include "trace_stream.h"
+
+#define TRACE_EVENT_BYTES 4
+
+static FILE* pxStreamFile = NULL;
+static const char* pcSnapshotName = NULL;
+static HANDLE xSnapshotRequest = NULL;
+static HANDLE xSnapshotDone = NULL;
+static uint32_t ulLastIndex = 0;
+static volatile uint64_t ullStreamed = 0;
+static RecorderDataType xSnapshotCopy; // too big for the thread stack
+
+static void prvWriteSlots(uint32_t ulFrom, uint32_t ulTo) {
+    if (ulTo > ulFrom) {
+        fwrite(&RecorderDataPtr->eventData[ulFrom * TRACE_EVENT_BYTES], TRACE_EVENT_BYTES, ulTo - ulFrom, pxStreamFile);
+        ullStreamed += ulTo - ulFrom;
+    }
+}
+
+/* Append whatever the recorder wrote since the last pass. */
+static void prvDrain(void) {
+    uint32_t ulIndex = *(volatile uint32_t*)&RecorderDataPtr->nextFreeIndex;
+    uint32_t ulMax = RecorderDataPtr->maxEvents;
+
+    if (ulIndex == ulLastIndex) {
+        return;
+    }
+    if (ulIndex > ulLastIndex) {
+        prvWriteSlots(ulLastIndex, ulIndex);
+    }
+    else {
+        // wrapped: the tail of the ring, then its start
+        prvWriteSlots(ulLastIndex, ulMax);
+        prvWriteSlots(0, ulIndex);
+    }
+    ulLastIndex = ulIndex;
+    fflush(pxStreamFile);
+}
+
+static void prvWriteSnapshot(void) {
+    FILE* pxOutputFile;
+
+    if (pcSnapshotName == NULL) {
+        return;
+    }
+    memcpy(&xSnapshotCopy, RecorderDataPtr, sizeof(RecorderDataType));
+    fopen_s(&pxOutputFile, pcSnapshotName, "wb");
+    if (pxOutputFile != NULL) {
+        fwrite(&xSnapshotCopy, sizeof(RecorderDataType), 1, pxOutputFile);
+        fclose(pxOutputFile);
+        printf("\r\nTrace output saved to %s\r\n\r\n", pcSnapshotName);
+    }
+    else {
+        printf("\r\nFailed to create trace dump file\r\n\r\n");
+    }
+}
+
+static DWORD WINAPI prvTraceStreamThread(void* pvParam) {
+    (void)pvParam;
+
+    for (;;) {
+        if (WaitForSingleObject(xSnapshotRequest, TRACE_STREAM_PERIOD_MS) == WAIT_OBJECT_0) {
+            prvDrain();
+            prvWriteSnapshot();
+            SetEvent(xSnapshotDone);
+        }
+        prvDrain();
+    }
+
+    /* Should not get here so return negative exit status. */
+    return (DWORD)-1;
+}
+
+int xTraceStreamStart(const char* pcStreamFile, const char* pcSnapshotFile) {
+    HANDLE xThread;
+
+    pcSnapshotName = pcSnapshotFile;
+    fopen_s(&pxStreamFile, pcStreamFile, "wb");
+    if (pxStreamFile == NULL) {
+        return 0;
+    }
+
+    // the tables the events refer to, then the events from where the recorder is now
+    ulLastIndex = RecorderDataPtr->nextFreeIndex;
+    fwrite(RecorderDataPtr, sizeof(RecorderDataType), 1, pxStreamFile);
+
+    xSnapshotRequest = CreateEvent(NULL, FALSE, FALSE, NULL);
+    xSnapshotDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+    xThread = CreateThread(NULL, 0, prvTraceStreamThread, NULL, 0, NULL);
+    if (xSnapshotRequest == NULL || xSnapshotDone == NULL || xThread == NULL) {
+        return 0;
+    }
+
+    /* Like the keyboard thread: keep off the core the FreeRTOS threads run on. */
+    SetThreadAffinityMask(xThread, ~0x01u);
+    SetThreadPriority(xThread, THREAD_PRIORITY_BELOW_NORMAL);
+    return 1;
+}
+
+void vTraceStreamRequestSnapshot(void) {
+    if (xSnapshotRequest != NULL) {
+        SetEvent(xSnapshotRequest);
+    }
+}
+
+int xTraceStreamSnapshotAndWait(void) {
+    if (xSnapshotRequest == NULL) {
+        return 0;
+    }
+    ResetEvent(xSnapshotDone);
+    SetEvent(xSnapshotRequest);
+    return WaitForSingleObject(xSnapshotDone, TRACE_STREAM_SNAPSHOT_WAIT_MS) == WAIT_OBJECT_0;
+}
+
+uint64_t ullTraceStreamEvents(void) {
+    return ullStreamed;
+}
@@ -0,0 +1,41 @@
+/* trace_stream.h
+   Background writer for the trace recorder's snapshot buffer (Win32 simulator only).
+   - a Windows thread outside the scheduler, on the cores the FreeRTOS threads do not use,
+     wakes every TRACE_STREAM_PERIOD_MS and appends the event slots written since its last
+     pass to the stream file, so traces longer than the ring buffer can be captured
+   - the stream file starts with one whole RecorderDataType (object and symbol tables as
+     they were at start-up), followed by the raw 4-byte event slots in recording order
+   - snapshot requests (the trace key, vAssertCalled) only signal the thread: it copies
+     RecorderDataType with a memcpy and writes the copy, so no FreeRTOS critical section is
+     held for the disk write
+   Nothing here takes a lock against the recorder. The slot that is being written while the
+   thread copies can come out torn, and if the ring laps within one period the stream misses
+   the overwritten events, so the period has to stay well below the time the recorder needs
+   to fill its buffer. The recorder must be in ring-buffer mode, otherwise it stops once the
+   buffer is full.
+*/
+
+#ifndef TRACE_STREAM_H
+#define TRACE_STREAM_H
+
+#include <stdint.h>
+
+#define TRACE_STREAM_PERIOD_MS 10
+#define TRACE_STREAM_SNAPSHOT_WAIT_MS 5000
+
+/* Open pcStreamFile and start the drain thread. Call after xTraceEnable(). pcSnapshotFile
+   may be NULL when snapshots are taken some other way (trace_map.h). Returns 0 when the
+   file or the thread could not be created. */
+int xTraceStreamStart(const char* pcStreamFile, const char* pcSnapshotFile);
+
+/* Ask for a snapshot file to be written and return at once. Safe from a simulated ISR. */
+void vTraceStreamRequestSnapshot(void);
+
+/* Ask for a snapshot and wait until it is on disk, for use where the system is about to
+   stop (vAssertCalled). Returns 0 on timeout. */
+int xTraceStreamSnapshotAndWait(void);
+
+/* Event slots written to the stream file so far. */
+uint64_t ullTraceStreamEvents(void);
+
+#endif /* TRACE_STREAM_H */